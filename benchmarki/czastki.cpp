@@ -0,0 +1,119 @@
+// Benchmarki systemu cząsteczek z zadanie_5
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include "../zadanie_5/particles.hpp"
+
+namespace {
+
+const float dt = 1.0f / 60.0f;
+
+// Particle::update dla N cząsteczek, bez kół i z 10 kołami
+void BM_ParticleUpdate(benchmark::State& state) {
+    std::vector<Particle> particles;
+    GeneratorLosowy generator(42);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        float vx = generator.przedzial(-50.0f, 50.0f);
+        float vy = generator.przedzial(-50.0f, 50.0f);
+        particles.emplace_back(Vector3D(400, 300, 0), Vector3D(vx, vy, 0),
+                               sf::Color::White, 1e9f, 1.0f);
+    }
+    std::vector<Circle> circles;
+    for (int64_t i = 0; i < state.range(1); ++i) {
+        circles.emplace_back(Vector3D(100.0f + 60.0f * i, 300, 0), 50.0f);
+    }
+    Vector3D wind(5, 0, 0), attractionPoint(400, 300, 0);
+    for (auto _ : state) {
+        for (auto& particle : particles) {
+            particle.update(dt, wind, attractionPoint, circles);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleUpdate)->ArgsProduct({{100, 1000, 10000, 100000, 1000000}, {0, 10}});
+
+// To samo z kołami w ObstacleGrid; 1000 kół o promieniu 50 pokrywa okno kilkanaście razy
+void BM_ParticleUpdateGrid(benchmark::State& state) {
+    std::vector<Particle> particles;
+    GeneratorLosowy generator(42);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        float vx = generator.przedzial(-50.0f, 50.0f);
+        float vy = generator.przedzial(-50.0f, 50.0f);
+        particles.emplace_back(Vector3D(400, 300, 0), Vector3D(vx, vy, 0),
+                               sf::Color::White, 1e9f, 1.0f);
+    }
+    ObstacleGrid obstacles;
+    for (int64_t i = 0; i < state.range(1); ++i) {
+        float cx = generator.przedzial(0, 800);
+        float cy = generator.przedzial(0, 600);
+        obstacles.add(Circle(Vector3D(cx, cy, 0), 50.0f));
+    }
+    Vector3D wind(5, 0, 0), attractionPoint(400, 300, 0);
+    for (auto _ : state) {
+        for (auto& particle : particles) {
+            particle.update(dt, wind, attractionPoint, obstacles);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleUpdateGrid)->ArgsProduct({{100, 1000, 10000, 100000, 1000000}, {0, 10, 1000}});
+
+// Emitter::update (ruch + usuwanie martwych) dla N żywych cząsteczek
+void BM_EmitterUpdate(benchmark::State& state) {
+    const std::size_t budget = static_cast<std::size_t>(state.range(0));
+    Emitter emitter(Vector3D(400, 300, 0), budget);
+    ObstacleGrid obstacles;
+    Vector3D wind(0, 0, 0), attractionPoint(400, 300, 0);
+    emitter.emit(static_cast<int>(state.range(0)));
+    int steps = 0;
+    for (auto _ : state) {
+        // Cząsteczki żyją co najmniej 3 s, więc co 150 kroków emiter jest wypełniany od nowa
+        if (++steps == 150) {
+            state.PauseTiming();
+            emitter = Emitter(Vector3D(400, 300, 0), budget);
+            emitter.emit(static_cast<int>(state.range(0)));
+            steps = 0;
+            state.ResumeTiming();
+        }
+        emitter.update(dt, wind, attractionPoint, obstacles);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EmitterUpdate)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Wypełnienie N floatów z [-1, 1): 0 - rand(), 1 - std::mt19937, 2 - GeneratorLosowy,
+// 3 - wypelnijLicznikowo (bez stanu, pętla do wektoryzacji)
+void BM_RandomFill(benchmark::State& state) {
+    std::vector<float> values(static_cast<std::size_t>(state.range(0)));
+    std::srand(42);
+    std::mt19937 mersenne(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    GeneratorLosowy generator(42);
+    std::uint64_t counter = 0;
+    for (auto _ : state) {
+        switch (state.range(1)) {
+        case 0:
+            for (auto& v : values) v = std::rand() * (2.0f / (RAND_MAX + 1.0f)) - 1.0f;
+            break;
+        case 1:
+            for (auto& v : values) v = distribution(mersenne);
+            break;
+        case 2:
+            for (auto& v : values) v = generator.przedzial(-1.0f, 1.0f);
+            break;
+        default:
+            wypelnijLicznikowo(values.data(), values.size(), -1.0f, 1.0f, 42, counter);
+            counter += values.size();
+            break;
+        }
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RandomFill)->ArgsProduct({{100000}, {0, 1, 2, 3}});
+
+} // namespace
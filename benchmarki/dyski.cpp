@@ -0,0 +1,257 @@
+// Benchmarki kerneli symulacji dysków (zadanie_3, zadanie_4)
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <cmath>
+#include "../zadanie_3/grawitacja.hpp"
+#include "../zadanie_4/siatka.hpp"
+#include "../zadanie_4/zderzenia.hpp"
+#include "../zadanie_4/silnik_zdarzen.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/calkowanie.hpp"
+#include "../wspolne/porzadek_mortona.hpp"
+#include "../wspolne/pole_przyciagania.hpp"
+
+namespace {
+
+// Dyski losowane w kwadracie o stałej gęstości (około 200 dysków na okno 800x600)
+MagazynDyskow losoweDyski(int n, unsigned ziarno = 42) {
+    GeneratorLosowy gen(ziarno);
+    float bok = std::sqrt(n / 200.0f * 800.0f * 600.0f);
+    MagazynDyskow dyski;
+    for (int i = 0; i < n; ++i) {
+        float x = gen.przedzial(0, bok), y = gen.przedzial(0, bok);
+        float vx = gen.przedzial(-50, 50), vy = gen.przedzial(-50, 50);
+        float masa = gen.przedzial(1, 5), srednica = gen.przedzial(10, 40);
+        dyski.dodaj(x, y, vx, vy, masa, srednica, 0.03f, sf::Color::White);
+    }
+    return dyski;
+}
+
+// Przyciąganie każdego dysku do jednego punktu - N wywołań silaPrzyciagania
+void BM_SilaPrzyciagania(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    sf::Vector2f punkt(400, 300);
+    for (auto _ : state) {
+        sf::Vector2f suma(0, 0);
+        for (size_t i = 0; i < dyski.rozmiar(); ++i) {
+            suma += silaPrzyciagania(dyski.pozycja(i), punkt, 100.0f);
+        }
+        benchmark::DoNotOptimize(suma);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SilaPrzyciagania)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Pełna faza sił Barnesa-Huta (budowa drzewa + siły dla wszystkich dysków)
+void BM_BarnesHut(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    DrzewoKwadrantowe drzewo;
+    for (auto _ : state) {
+        drzewo.zbuduj(dyski);
+        sf::Vector2f suma(0, 0);
+        for (size_t i = 0; i < dyski.rozmiar(); ++i) {
+            suma += drzewo.sila(static_cast<int>(i), dyski, 0.7f, 100.0f);
+        }
+        benchmark::DoNotOptimize(suma);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BarnesHut)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+// To samo liśćmi drzewa (pełny krok zadanie_3): jedno przejście drzewa na liść
+void BM_BarnesHutLiscmi(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    DrzewoKwadrantowe drzewo;
+    DrzewoKwadrantowe::ListaOddzialywan lista;
+    std::vector<float> silyX(dyski.rozmiar()), silyY(dyski.rozmiar());
+    for (auto _ : state) {
+        drzewo.zbuduj(dyski);
+        for (std::size_t l = 0; l < drzewo.liczbaLisci(); ++l) {
+            drzewo.silyLiscia(l, 0.7f, 100.0f, lista, silyX.data(), silyY.data());
+        }
+        benchmark::DoNotOptimize(silyX.data());
+        benchmark::DoNotOptimize(silyY.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BarnesHutLiscmi)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+// Kernele całkowania SoA
+void BM_CalkowanieSoA(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    TablicaWyrownana fx(dyski.rozmiar(), 1.0f), fy(dyski.rozmiar(), -1.0f);
+    for (auto _ : state) {
+        dyski.zastosujSily(fx.data(), fy.data(), 0.01f);
+        dyski.zaktualizujPozycje(0.01f, 1e6f, 1e6f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalkowanieSoA)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Pełny krok każdej metody całkowania z przyciąganiem do jednego punktu; argument 0/1/2 to
+// euler/leapfrog/rk4 - koszt ponad ewaluacje sił widać w porównaniu z BM_SilaPrzyciagania
+void BM_MetodaCalkowania(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(100000);
+    Calkownik calkownik;
+    calkownik.metoda = static_cast<MetodaCalkowania>(state.range(0));
+    sf::Vector2f punkt(400, 300);
+    auto sily = [&](const MagazynDyskow& stan, float* fx, float* fy) {
+        for (std::size_t i = 0; i < stan.rozmiar(); ++i) {
+            sf::Vector2f f = silaPrzyciagania(stan.pozycja(i), punkt, 100.0f);
+            fx[i] = f.x;
+            fy[i] = f.y;
+        }
+    };
+    for (auto _ : state) {
+        calkownik.krok(dyski, 1e6f, 1e6f, sily, [](std::size_t n, const auto& zadanie) { zadanie(0, n); });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(dyski.rozmiar()));
+    state.SetLabel(nazwaMetody(calkownik.metoda));
+}
+BENCHMARK(BM_MetodaCalkowania)->DenseRange(0, 2);
+
+// Faza szeroka: budowa siatki i wyliczenie par kandydujących
+void BM_SiatkaFazaSzeroka(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    SiatkaPrzestrzenna siatka;
+    for (auto _ : state) {
+        siatka.zbuduj(dyski.x.data(), dyski.y.data(), static_cast<int>(dyski.rozmiar()), 40.0f);
+        long long pary = 0;
+        siatka.dlaParKandydujacych([&](int, int) { ++pary; });
+        benchmark::DoNotOptimize(pary);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SiatkaFazaSzeroka)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Faza wąska: zderzeniaSprężyste na parach kandydujących wyznaczonych raz przed pomiarem
+void BM_ZderzeniaSprezyste(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    SiatkaPrzestrzenna siatka;
+    siatka.zbuduj(dyski.x.data(), dyski.y.data(), static_cast<int>(dyski.rozmiar()), 40.0f);
+    std::vector<std::pair<int, int>> pary;
+    siatka.dlaParKandydujacych([&](int i, int j) { pary.emplace_back(i, j); });
+    for (auto _ : state) {
+        long long kontakty = 0;
+        for (const auto& para : pary) {
+            if (zderzeniaSprężyste(dyski, para.first, para.second)) ++kontakty;
+        }
+        benchmark::DoNotOptimize(kontakty);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pary.size()));
+    state.counters["pary"] = static_cast<double>(pary.size());
+}
+BENCHMARK(BM_ZderzeniaSprezyste)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Pełna faza zderzeń zadanie_4 (siatka i zderzeniaSprężyste) oraz siły Barnesa-Huta zadanie_3
+// dla dysków w kolejności utworzenia (0) i po porządkowaniu Mortona (1)
+void BM_PorzadekMortona(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    PorzadekMortona porzadek;
+    if (state.range(1)) dyski.przestaw(porzadek.uporzadkuj(dyski.x.data(), dyski.y.data(), dyski.rozmiar()));
+    SiatkaPrzestrzenna siatka;
+    DrzewoKwadrantowe drzewo;
+    for (auto _ : state) {
+        siatka.zbuduj(dyski.x.data(), dyski.y.data(), static_cast<int>(dyski.rozmiar()), 40.0f);
+        long long kontakty = 0;
+        siatka.dlaParKandydujacych([&](int i, int j) {
+            if (zderzeniaSprężyste(dyski, i, j)) ++kontakty;
+        });
+        drzewo.zbuduj(dyski);
+        sf::Vector2f suma(0, 0);
+        for (size_t i = 0; i < dyski.rozmiar(); ++i) {
+            suma += drzewo.sila(static_cast<int>(i), dyski, 0.7f, 100.0f);
+        }
+        benchmark::DoNotOptimize(kontakty);
+        benchmark::DoNotOptimize(suma);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(state.range(1) ? "morton" : "utworzenie");
+}
+BENCHMARK(BM_PorzadekMortona)->ArgsProduct({{100000, 1000000}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// Koszt samego porządkowania: klucze, sortowanie pozycyjne i przestawienie tablic
+void BM_Uporzadkowanie(benchmark::State& state) {
+    MagazynDyskow dyski = losoweDyski(static_cast<int>(state.range(0)));
+    PorzadekMortona porzadek;
+    for (auto _ : state) {
+        dyski.przestaw(porzadek.uporzadkuj(dyski.x.data(), dyski.y.data(), dyski.rozmiar()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Uporzadkowanie)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Zderzenia sterowane zdarzeniami w oknie 800x600 jak w zadanie_4 --events; przy 800 i więcej
+// dyskach nachodzą one na siebie od startu; krok przerwany po limicie zdarzeń to błąd
+void BM_SilnikZdarzen(benchmark::State& state) {
+    GeneratorLosowy gen(1);
+    MagazynDyskow dyski;
+    for (int i = 0; i < state.range(0); ++i) {
+        float x = gen.przedzial(0, 750), y = gen.przedzial(0, 550);
+        float vx = gen.przedzial(-50, 50), vy = gen.przedzial(-50, 50);
+        float masa = gen.przedzial(1, 5), srednica = gen.przedzial(10, 40);
+        dyski.dodaj(x, y, vx, vy, masa, srednica, 0.0f, sf::Color::White);
+    }
+    SilnikZdarzen silnik;
+    for (auto _ : state) {
+        silnik.przesun(dyski, 0.01, 800, 600, 40);
+    }
+    if (silnik.liczbaPrzerwanych() > 0) state.SkipWithError("kroki przerwane po limicie zdarzeń");
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["zdarzenia"] = static_cast<double>(silnik.liczbaZdarzen());
+}
+BENCHMARK(BM_SilnikZdarzen)->Arg(200)->Arg(800)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+// Przyciąganie 10 000 dysków w oknie 800x600 do P punktów: suma po punktach (0)
+// albo siatka pola przyciągania (1), wypieczona przed pomiarem
+void BM_PolePrzyciagania(benchmark::State& state) {
+    GeneratorLosowy gen(7);
+    std::vector<sf::Vector2f> punkty, pozycje;
+    for (int p = 0; p < state.range(0); ++p) punkty.emplace_back(gen.przedzial(0, 800), gen.przedzial(0, 600));
+    for (int i = 0; i < 10000; ++i) pozycje.emplace_back(gen.przedzial(0, 800), gen.przedzial(0, 600));
+    auto silaPunktu = [](const sf::Vector2f& pozycja, const sf::Vector2f& punkt) {
+        return silaPrzyciagania(pozycja, punkt, 100.0f);
+    };
+    PolePrzyciagania pole;
+    pole.minPunktow = state.range(1) ? 0 : punkty.size() + 1;
+    pole.zaktualizuj(punkty, 800, 600, silaPunktu);
+    for (auto _ : state) {
+        sf::Vector2f suma(0, 0);
+        for (const auto& pozycja : pozycje) suma += pole.sila(pozycja, punkty, silaPunktu);
+        benchmark::DoNotOptimize(suma);
+    }
+    state.SetItemsProcessed(state.iterations() * pozycje.size());
+    state.SetLabel(state.range(1) ? "siatka" : "suma");
+}
+BENCHMARK(BM_PolePrzyciagania)->ArgsProduct({{10, 100, 1000}, {0, 1}});
+
+// Wypiekanie jednego nowego punktu - koszt kliknięcia w oknie, gdy range(0) punktów jest już
+// w siatce. Siatka z tymi punktami odtwarzana jest przed każdą iteracją poza pomiarem, więc
+// koszt nie rośnie z liczbą iteracji.
+void BM_WypiekaniePunktu(benchmark::State& state) {
+    GeneratorLosowy gen(7);
+    std::vector<sf::Vector2f> punkty;
+    for (int64_t i = 0; i < state.range(0); ++i) punkty.emplace_back(gen.przedzial(0, 800), gen.przedzial(0, 600));
+    auto silaPunktu = [](const sf::Vector2f& pozycja, const sf::Vector2f& punkt) {
+        return silaPrzyciagania(pozycja, punkt, 100.0f);
+    };
+    PolePrzyciagania bazowe;
+    bazowe.minPunktow = 0;
+    bazowe.zaktualizuj(punkty, 800, 600, silaPunktu);
+    const std::size_t liczbaBazowych = punkty.size();
+    PolePrzyciagania pole;
+    for (auto _ : state) {
+        state.PauseTiming();
+        pole = bazowe;
+        punkty.resize(liczbaBazowych);
+        punkty.emplace_back(gen.przedzial(0, 800), gen.przedzial(0, 600));
+        state.ResumeTiming();
+        pole.zaktualizuj(punkty, 800, 600, silaPunktu);
+    }
+}
+BENCHMARK(BM_WypiekaniePunktu)->Arg(0)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+} // namespace
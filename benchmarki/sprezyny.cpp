@@ -0,0 +1,132 @@
+// Benchmarki modelu sprężynowego z zadanie_7
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <cstdint>
+#include "../zadanie_7/constraint_solver.hpp"
+#include "../zadanie_7/cloth_generator.hpp"
+#include "../zadanie_7/particle_grid.hpp"
+
+namespace {
+
+// Spring::applyConstraint dla łańcucha N cząsteczek (N - 1 sprężyn)
+void BM_SpringApplyConstraint(benchmark::State& state) {
+    ClothGraph graph;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        graph.addParticle(sf::Vector2f(10.f * i, 300.f + (i % 2) * 5.f), i == 0);
+    }
+    for (std::uint32_t i = 0; i + 1 < graph.getParticles().size(); ++i) {
+        graph.addSpring(i, i + 1);
+    }
+    for (auto _ : state) {
+        graph.applyConstraints();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getSprings().size()));
+}
+BENCHMARK(BM_SpringApplyConstraint)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Jedna iteracja ConstraintSolver (partie kolorów) dla tego samego łańcucha
+void BM_ConstraintSolver(benchmark::State& state) {
+    ClothGraph graph;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        graph.addParticle(sf::Vector2f(10.f * i, 300.f + (i % 2) * 5.f), i == 0);
+    }
+    for (std::uint32_t i = 0; i + 1 < graph.getParticles().size(); ++i) {
+        graph.addSpring(i, i + 1);
+    }
+    PulaWatkow pool(1); // jeden wątek - zysk z samych partii, porównywalny z BM_SpringApplyConstraint
+    ConstraintSolver solver;
+    solver.update(graph);
+    for (auto _ : state) {
+        solver.solve(graph, pool);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getSprings().size()));
+}
+BENCHMARK(BM_ConstraintSolver)->RangeMultiplier(10)->Range(100, 1000000)->UseRealTime();
+
+// Pełny krok tkaniny N x N (grawitacja, Verlet, jedna iteracja solvera); N = 130 to ok. 100k sprężyn
+void BM_ClothStep(benchmark::State& state) {
+    ClothGraph graph;
+    ClothParams params;
+    params.columns = params.rows = static_cast<int>(state.range(0));
+    params.spacing = 5.f;
+    buildCloth(graph, params);
+    PulaWatkow pool(1); // jeden wątek - czas kroku na jednym rdzeniu
+    ConstraintSolver solver;
+    for (auto _ : state) {
+        for (auto& particle : graph.getParticles()) {
+            particle.applyForce(sf::Vector2f(0.f, 500.f));
+            particle.update(0.016f);
+        }
+        solver.solve(graph, pool);
+        benchmark::ClobberMemory();
+    }
+    state.counters["springs"] = static_cast<double>(graph.getSprings().size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph.getSprings().size()));
+}
+BENCHMARK(BM_ClothStep)->Arg(32)->Arg(64)->Arg(130)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// ParticleGrid::nearest na tkaninie N x N - czas zapytania nie powinien rosnąć z rozmiarem siatki
+void BM_GridNearest(benchmark::State& state) {
+    ClothGraph graph;
+    ClothParams params;
+    params.columns = params.rows = static_cast<int>(state.range(0));
+    params.spacing = 5.f;
+    buildCloth(graph, params);
+    ParticleGrid grid(20.f);
+    grid.rebuild(graph);
+    float extent = params.spacing * (params.columns - 1);
+    std::uint32_t k = 0;
+    for (auto _ : state) {
+        // Deterministyczny ciąg punktów rozrzuconych po tkaninie
+        float x = params.origin.x + extent * ((k * 2654435761u) % 1000) / 1000.f;
+        float y = params.origin.y + extent * ((k * 40503u) % 1000) / 1000.f;
+        ++k;
+        benchmark::DoNotOptimize(grid.nearest(graph, x, y));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GridNearest)->Arg(32)->Arg(130)->Arg(320)->Arg(1000);
+
+// Dodanie i usunięcie cząsteczki ze sprężyną w grafie N cząsteczek - koszt nie powinien rosnąć z N
+void BM_ClothGraphAddRemove(benchmark::State& state) {
+    ClothGraph graph;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        graph.addParticle(sf::Vector2f(10.f * i, 300.f));
+    }
+    for (std::uint32_t i = 0; i + 1 < graph.getParticles().size(); ++i) {
+        graph.addSpring(i, i + 1);
+    }
+    std::uint32_t k = 0;
+    for (auto _ : state) {
+        // Zawsze ze środka grafu, żeby usunięcie przenosiło ostatnią cząsteczkę
+        ParticleHandle middle = graph.handleOf(k++ % (graph.getParticles().size() / 2));
+        ParticleHandle added = graph.addParticle(sf::Vector2f(5.f, 5.f));
+        graph.addSpring(middle, added);
+        graph.removeParticle(added);
+        graph.removeParticle(middle);
+        graph.addParticle(sf::Vector2f(7.f, 7.f));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ClothGraphAddRemove)->RangeMultiplier(10)->Range(100, 1000000);
+
+// Particle::update (całkowanie Verleta) dla N cząsteczek
+void BM_VerletUpdate(benchmark::State& state) {
+    std::vector<Particle> particles;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        particles.emplace_back(sf::Vector2f(static_cast<float>(i % 800), static_cast<float>(i / 800)));
+    }
+    for (auto _ : state) {
+        for (auto& particle : particles) {
+            particle.applyForce(sf::Vector2f(0.f, 500.f));
+            particle.update(0.016f);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_VerletUpdate)->RangeMultiplier(10)->Range(100, 1000000);
+
+} // namespace
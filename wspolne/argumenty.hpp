@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <cstdlib>
+
+// Proste argumenty wiersza poleceń w postaci --nazwa wartość lub --nazwa=wartość
+class Argumenty {
+public:
+    Argumenty(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0) continue;
+            arg = arg.substr(2);
+            std::size_t rowne = arg.find('=');
+            if (rowne != std::string::npos) {
+                wartosci[arg.substr(0, rowne)] = arg.substr(rowne + 1);
+            } else if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                wartosci[arg] = argv[++i];
+            } else {
+                wartosci[arg] = "";
+            }
+        }
+    }
+
+    bool jest(const std::string& nazwa) const { return wartosci.count(nazwa) != 0; }
+
+    std::string tekst(const std::string& nazwa, const std::string& domyslny) const {
+        auto it = wartosci.find(nazwa);
+        return it != wartosci.end() ? it->second : domyslny;
+    }
+
+    long long liczbaCalkowita(const std::string& nazwa, long long domyslna) const {
+        auto it = wartosci.find(nazwa);
+        return it != wartosci.end() && !it->second.empty() ? std::atoll(it->second.c_str()) : domyslna;
+    }
+
+    float liczba(const std::string& nazwa, float domyslna) const {
+        auto it = wartosci.find(nazwa);
+        return it != wartosci.end() && !it->second.empty() ? static_cast<float>(std::atof(it->second.c_str())) : domyslna;
+    }
+
+private:
+    std::map<std::string, std::string> wartosci;
+};
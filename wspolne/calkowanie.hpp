@@ -0,0 +1,228 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cmath>
+#include <cstddef>
+#include "magazyn_dyskow.hpp"
+#include "argumenty.hpp"
+
+// Metody całkowania ruchu dysków:
+// - euler: dotychczasowy krok (najpierw prędkość, potem pozycja), 1 ewaluacja sił na krok,
+// - leapfrog: prędkościowy Verlet w wariancie kick-drift-kick; siły z końca kroku służą
+//   za siły początku następnego, więc też 1 ewaluacja na krok, ale drugi rząd dokładności
+//   i (bez oporu) brak systematycznego dryfu energii,
+// - rk4: klasyczna metoda Rungego-Kutty, 4 ewaluacje sił na krok.
+enum class MetodaCalkowania { Euler, Leapfrog, RK4 };
+
+inline const char* nazwaMetody(MetodaCalkowania metoda) {
+    switch (metoda) {
+        case MetodaCalkowania::Leapfrog: return "leapfrog";
+        case MetodaCalkowania::RK4: return "rk4";
+        default: return "euler";
+    }
+}
+
+// false dla nieznanej nazwy
+inline bool parsujMetode(const std::string& nazwa, MetodaCalkowania& metoda) {
+    if (nazwa == "euler") metoda = MetodaCalkowania::Euler;
+    else if (nazwa == "leapfrog" || nazwa == "verlet") metoda = MetodaCalkowania::Leapfrog;
+    else if (nazwa == "rk4") metoda = MetodaCalkowania::RK4;
+    else return false;
+    return true;
+}
+
+inline MetodaCalkowania nastepnaMetoda(MetodaCalkowania metoda) {
+    switch (metoda) {
+        case MetodaCalkowania::Euler: return MetodaCalkowania::Leapfrog;
+        case MetodaCalkowania::Leapfrog: return MetodaCalkowania::RK4;
+        default: return MetodaCalkowania::Euler;
+    }
+}
+
+// Krok całkowania wspólny dla wszystkich metod. Siły zależą tylko od pozycji; opór
+// (-wsp_oporu * v) i odbicia od krawędzi liczone są tak jak w MagazynDyskow.
+// obliczSily(stan, fx, fy) wypełnia siły dla pozycji z podanego stanu (dla RK4 jest to
+// stan pośredni, nie sam magazyn), bloki(n, zadanie) wykonuje zadanie(od, do) na
+// rozłącznych przedziałach [0, n) - np. przez PulaWatkow.
+class Calkownik {
+public:
+    MetodaCalkowania metoda = MetodaCalkowania::Euler;
+    float dt = 0.01f;
+
+    // Siły zapamiętane przez leapfrog są nieaktualne - po zmianie pozycji lub sił poza krokiem
+    // (wczytanie migawki, nowy punkt przyciągania, zmiana metody)
+    void uniewaznij() { silyAktualne = false; }
+
+    // Łączna liczba ewaluacji sił
+    long long ewaluacje() const { return liczbaEwaluacji; }
+
+    // Siły zapamiętane przez leapfrog idą za dyskami przestawionymi przez MagazynDyskow::przestaw
+    void przestaw(const std::vector<std::uint32_t>& kolejnosc) {
+        if (fx.size() != kolejnosc.size()) return;
+        ::przestaw(fx, kolejnosc);
+        ::przestaw(fy, kolejnosc);
+    }
+
+    template <typename Sily, typename Bloki>
+    void krok(MagazynDyskow& dyski, float szerokosc, float wysokosc, Sily obliczSily, Bloki bloki) {
+        const std::size_t n = dyski.rozmiar();
+        if (fx.size() != n) {
+            fx.resize(n);
+            fy.resize(n);
+            silyAktualne = false;
+        }
+
+        if (metoda == MetodaCalkowania::Euler) {
+            ewaluuj(dyski, obliczSily);
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                dyski.zastosujSily(fx.data(), fy.data(), dt, od, doIndeksu);
+                dyski.zaktualizujPozycje(dt, szerokosc, wysokosc, od, doIndeksu);
+            });
+            silyAktualne = false;
+        } else if (metoda == MetodaCalkowania::Leapfrog) {
+            if (!silyAktualne) ewaluuj(dyski, obliczSily);
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                dyski.zastosujSily(fx.data(), fy.data(), 0.5f * dt, od, doIndeksu);
+                dyski.zaktualizujPozycje(dt, szerokosc, wysokosc, od, doIndeksu);
+            });
+            ewaluuj(dyski, obliczSily);
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                dyski.zastosujSily(fx.data(), fy.data(), 0.5f * dt, od, doIndeksu);
+            });
+            silyAktualne = true;
+        } else {
+            krokRK4(dyski, szerokosc, wysokosc, obliczSily, bloki);
+            silyAktualne = false;
+        }
+    }
+
+private:
+    TablicaWyrownana fx, fy;
+    bool silyAktualne = false;
+    long long liczbaEwaluacji = 0;
+
+    // RK4: stan pośredni i sumy ważone pochodnych pozycji (prędkości) i prędkości (przyspieszeń)
+    MagazynDyskow etap;
+    TablicaWyrownana sumaX, sumaY, sumaVX, sumaVY;
+
+    template <typename Sily>
+    void ewaluuj(const MagazynDyskow& stan, Sily& obliczSily) {
+        obliczSily(stan, fx.data(), fy.data());
+        ++liczbaEwaluacji;
+    }
+
+    template <typename Sily, typename Bloki>
+    void krokRK4(MagazynDyskow& dyski, float szerokosc, float wysokosc, Sily& obliczSily, Bloki& bloki) {
+        const std::size_t n = dyski.rozmiar();
+        // Stan pośredni: pozycje i prędkości zmieniane przez etapy, masy dla sił grawitacji
+        etap.x = dyski.x;
+        etap.y = dyski.y;
+        etap.vx = dyski.vx;
+        etap.vy = dyski.vy;
+        etap.masa = dyski.masa;
+        sumaX.assign(n, 0.0f);
+        sumaY.assign(n, 0.0f);
+        sumaVX.assign(n, 0.0f);
+        sumaVY.assign(n, 0.0f);
+
+        // Etap e: pochodne w stanie etap z wagą 1, 2, 2, 1, następny stan pośredni
+        // w odległości h/2, h/2, h od początku kroku
+        const float wagi[4] = {1.0f, 2.0f, 2.0f, 1.0f};
+        const float przesuniecia[3] = {0.5f * dt, 0.5f * dt, dt};
+        for (int e = 0; e < 4; ++e) {
+            ewaluuj(etap, obliczSily);
+            const float waga = wagi[e];
+            const float h = e < 3 ? przesuniecia[e] : 0.0f;
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                for (std::size_t i = od; i < doIndeksu; ++i) {
+                    float odwrotnoscMasy = 1.0f / dyski.masa[i];
+                    float evx = etap.vx[i], evy = etap.vy[i];
+                    float ax = (fx[i] - dyski.wsp_oporu[i] * evx) * odwrotnoscMasy;
+                    float ay = (fy[i] - dyski.wsp_oporu[i] * evy) * odwrotnoscMasy;
+                    sumaX[i] += waga * evx;
+                    sumaY[i] += waga * evy;
+                    sumaVX[i] += waga * ax;
+                    sumaVY[i] += waga * ay;
+                    etap.x[i] = dyski.x[i] + h * evx;
+                    etap.y[i] = dyski.y[i] + h * evy;
+                    etap.vx[i] = dyski.vx[i] + h * ax;
+                    etap.vy[i] = dyski.vy[i] + h * ay;
+                }
+            });
+        }
+
+        const float szostaKroku = dt / 6.0f;
+        bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+            for (std::size_t i = od; i < doIndeksu; ++i) {
+                dyski.x[i] += szostaKroku * sumaX[i];
+                dyski.y[i] += szostaKroku * sumaY[i];
+                dyski.vx[i] += szostaKroku * sumaVX[i];
+                dyski.vy[i] += szostaKroku * sumaVY[i];
+            }
+            dyski.odbijOdKrawedzi(szerokosc, wysokosc, od, doIndeksu);
+        });
+    }
+};
+
+// Bilans do pomiaru dryfu: energia kinetyczna, potencjalna (dolicza program, bo zależy
+// od jego sił) i pęd całkowity
+struct BilansEnergii {
+    double kinetyczna = 0, potencjalna = 0;
+    double pedX = 0, pedY = 0;
+
+    double calkowita() const { return kinetyczna + potencjalna; }
+    double ped() const { return std::sqrt(pedX * pedX + pedY * pedY); }
+};
+
+inline BilansEnergii bilansRuchu(const MagazynDyskow& dyski) {
+    BilansEnergii bilans;
+    for (std::size_t i = 0; i < dyski.rozmiar(); ++i) {
+        double m = dyski.masa[i];
+        bilans.kinetyczna += 0.5 * m * (static_cast<double>(dyski.vx[i]) * dyski.vx[i] +
+                                        static_cast<double>(dyski.vy[i]) * dyski.vy[i]);
+        bilans.pedX += m * dyski.vx[i];
+        bilans.pedY += m * dyski.vy[i];
+    }
+    return bilans;
+}
+
+// Energia potencjalna przyciągania intensywnosc / r² wspólnego dla zadań 3 i 4: -intensywnosc / r,
+// a poniżej r = 1, gdzie siła rośnie liniowo, intensywnosc * (r² / 2 - 3 / 2) - ciągła w r = 1
+inline double potencjalPrzyciagania(const sf::Vector2f& pozycja, const sf::Vector2f& punkt, float intensywnosc) {
+    sf::Vector2f d = punkt - pozycja;
+    double r = std::sqrt(static_cast<double>(d.x) * d.x + static_cast<double>(d.y) * d.y);
+    if (r < 1.0) return intensywnosc * (0.5 * r * r - 1.5);
+    return -intensywnosc / r;
+}
+
+// Dryf energii względem stanu początkowego i zmiana pędu. Przy oporze energia maleje
+// niezależnie od metody - do porównań metod służy --no-drag.
+inline void wypiszDryf(const BilansEnergii& poczatek, const BilansEnergii& koniec) {
+    double e0 = poczatek.calkowita(), e1 = koniec.calkowita();
+    std::printf("energia: %.6g -> %.6g (dryf względny %.3e), pęd: %.6g -> %.6g\n", e0, e1,
+                e0 != 0 ? (e1 - e0) / std::fabs(e0) : 0.0, poczatek.ped(), koniec.ped());
+}
+
+// Ewaluacje sił na sekundę czasu symulacji - miara kosztu metody przy danym dt
+inline void wypiszKosztCalkowania(const Calkownik& calkownik, long long kroki) {
+    double czasSymulacji = kroki * static_cast<double>(calkownik.dt);
+    std::printf("całkowanie: %s, dt = %g, ewaluacje sił = %lld (%.1f na sekundę symulacji)\n",
+                nazwaMetody(calkownik.metoda), calkownik.dt, calkownik.ewaluacje(),
+                czasSymulacji > 0 ? calkownik.ewaluacje() / czasSymulacji : 0.0);
+}
+
+// Wspólne opcje: --integrator euler|leapfrog|rk4, --dt KROK; false (z komunikatem) dla nieznanej metody
+inline bool ustawCalkownik(Calkownik& calkownik, const Argumenty& argumenty, float domyslnyKrok) {
+    calkownik.dt = argumenty.liczba("dt", domyslnyKrok);
+    std::string nazwa = argumenty.tekst("integrator", "euler");
+    if (!parsujMetode(nazwa, calkownik.metoda)) {
+        std::fprintf(stderr, "--integrator: nieznana metoda '%s' (euler, leapfrog, rk4)\n", nazwa.c_str());
+        return false;
+    }
+    if (!(calkownik.dt > 0)) {
+        std::fprintf(stderr, "--dt: krok musi być dodatni\n");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "argumenty.hpp"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Liczniki sprzętowe procesora przez perf_event_open (tylko Linux): odwołania i chybienia
+// pamięci podręcznej ostatniego poziomu oraz odczyty i chybienia L1D. Liczone są wątek
+// otwierający i wątki utworzone po otwarciu (np. PulaWatkow), tylko w przestrzeni użytkownika,
+// więc wystarcza perf_event_paranoid <= 2. Licznik, którego procesor lub jądro nie
+// udostępnia, jest pomijany; przy multipleksowaniu wartości są skalowane czasem pracy.
+class LicznikiSprzetowe {
+public:
+    LicznikiSprzetowe() = default;
+    LicznikiSprzetowe(const LicznikiSprzetowe&) = delete;
+    LicznikiSprzetowe& operator=(const LicznikiSprzetowe&) = delete;
+    ~LicznikiSprzetowe() { zamknij(); }
+
+    // false (z przyczyną w komunikat()), gdy nie udało się otworzyć żadnego licznika
+    bool otworz() {
+#if defined(__linux__)
+        const std::uint64_t l1Odczyt = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8);
+        const std::uint32_t typy[LICZBA] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                            PERF_TYPE_HW_CACHE};
+        const std::uint64_t konfiguracje[LICZBA] = {PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+                                                    l1Odczyt | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16),
+                                                    l1Odczyt | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        bool ktorys = false;
+        for (int k = 0; k < LICZBA; ++k) {
+            perf_event_attr atrybuty;
+            std::memset(&atrybuty, 0, sizeof(atrybuty));
+            atrybuty.size = sizeof(atrybuty);
+            atrybuty.type = typy[k];
+            atrybuty.config = konfiguracje[k];
+            atrybuty.disabled = 1;
+            atrybuty.inherit = 1;
+            atrybuty.exclude_kernel = 1;
+            atrybuty.exclude_hv = 1;
+            atrybuty.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[k] = static_cast<int>(syscall(SYS_perf_event_open, &atrybuty, 0, -1, -1, 0));
+            if (fd[k] >= 0) ktorys = true;
+            else if (blad.empty()) blad = std::string("perf_event_open: ") + std::strerror(errno);
+        }
+        return ktorys;
+#else
+        blad = "liczniki sprzętowe są dostępne tylko w Linuksie";
+        return false;
+#endif
+    }
+
+    void start() { steruj(true); }
+
+    // Zatrzymanie i odczyt; wartości są sumą od start()
+    void stop() {
+        steruj(false);
+#if defined(__linux__)
+        for (int k = 0; k < LICZBA; ++k) {
+            std::uint64_t odczyt[3] = {0, 0, 0};
+            wartosc[k] = -1;
+            if (fd[k] < 0 || read(fd[k], odczyt, sizeof(odczyt)) != static_cast<ssize_t>(sizeof(odczyt))) continue;
+            wartosc[k] = odczyt[2] > 0 ? static_cast<double>(odczyt[0]) * odczyt[1] / odczyt[2] : -1;
+        }
+#endif
+    }
+
+    bool otwarte() const {
+        for (int k = 0; k < LICZBA; ++k) {
+            if (fd[k] >= 0) return true;
+        }
+        return false;
+    }
+
+    const std::string& komunikat() const { return blad; }
+
+    // Chybienia na krok ciała pozwalają porównać przebiegi o różnej liczbie ciał i kroków
+    void wypisz(double krokiCial) const {
+        if (!otwarte()) {
+            std::printf("liczniki sprzętowe niedostępne (%s)\n", blad.c_str());
+            return;
+        }
+        wypiszPare("cache", wartosc[ODWOLANIA], wartosc[CHYBIENIA], krokiCial);
+        wypiszPare("L1D", wartosc[L1_ODCZYTY], wartosc[L1_CHYBIENIA], krokiCial);
+    }
+
+private:
+    enum { ODWOLANIA, CHYBIENIA, L1_ODCZYTY, L1_CHYBIENIA, LICZBA };
+    int fd[LICZBA] = {-1, -1, -1, -1};
+    double wartosc[LICZBA] = {-1, -1, -1, -1};
+    std::string blad;
+
+    void steruj(bool wlacz) {
+#if defined(__linux__)
+        for (int k = 0; k < LICZBA; ++k) {
+            if (fd[k] < 0) continue;
+            if (wlacz) ioctl(fd[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd[k], wlacz ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+        }
+#else
+        (void)wlacz;
+#endif
+    }
+
+    void zamknij() {
+#if defined(__linux__)
+        for (int k = 0; k < LICZBA; ++k) {
+            if (fd[k] >= 0) close(fd[k]);
+            fd[k] = -1;
+        }
+#endif
+    }
+
+    static void wypiszPare(const char* nazwa, double odwolania, double chybienia, double krokiCial) {
+        if (odwolania < 0 || chybienia < 0) {
+            std::printf("%s: licznik niedostępny\n", nazwa);
+            return;
+        }
+        std::printf("%s: odwołania = %.4g, chybienia = %.4g (%.2f%%, %.3f na krok ciała)\n", nazwa, odwolania,
+                    chybienia, odwolania > 0 ? 100.0 * chybienia / odwolania : 0.0,
+                    krokiCial > 0 ? chybienia / krokiCial : 0.0);
+    }
+};
+
+// --cache-misses: liczniki otwierane przed utworzeniem wątków programu, żeby je dziedziczyły.
+// Gdy się nie uda, przebieg idzie dalej bez nich, a wypisz() podaje przyczynę.
+inline bool wlaczLiczniki(LicznikiSprzetowe& liczniki, const Argumenty& argumenty) {
+    return argumenty.jest("cache-misses") && liczniki.otworz();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// Mieszanie SplitMix64: z kolejnych wartości licznika daje niezależnie wyglądające liczby.
+// Służy do rozsiewania generatora i jako generator licznikowy - wynik zależy tylko od
+// (ziarno, licznik), więc elementy mogą być losowane równolegle i w dowolnej kolejności.
+inline std::uint64_t mieszaj(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+inline std::uint64_t losowaLicznikowo(std::uint64_t ziarno, std::uint64_t licznik) {
+    return mieszaj(ziarno ^ mieszaj(licznik));
+}
+
+// 24 najstarsze bity jako float w [0, 1) - każda wartość dokładnie reprezentowalna
+inline float naUlamek(std::uint64_t x) {
+    return static_cast<float>(x >> 40) * (1.0f / 16777216.0f);
+}
+
+// Generator xoshiro256**: 32 bajty stanu, kilka operacji na liczbę. Spełnia wymagania
+// UniformRandomBitGenerator, więc działa też z rozkładami z <random>.
+class GeneratorLosowy {
+public:
+    typedef std::uint64_t result_type;
+
+    explicit GeneratorLosowy(std::uint64_t ziarno = 1) { seed(ziarno); }
+
+    void seed(std::uint64_t ziarno) {
+        poczatkoweZiarno = ziarno;
+        std::uint64_t x = ziarno;
+        for (auto& s : stan) {
+            s = mieszaj(x);
+            x += 0x9e3779b97f4a7c15ull;
+        }
+    }
+
+    // Ziarno z ostatniego seed() - razem z numerem strumienia wyznacza jego liczby
+    std::uint64_t ziarno() const { return poczatkoweZiarno; }
+
+    // Niezależny strumień o numerze indeks, np. na wątek albo na emitowaną cząsteczkę
+    GeneratorLosowy strumien(std::uint64_t indeks) const {
+        return GeneratorLosowy(losowaLicznikowo(poczatkoweZiarno, indeks));
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t wynik = obroc(stan[1] * 5, 7) * 9;
+        const std::uint64_t t = stan[1] << 17;
+        stan[2] ^= stan[0];
+        stan[3] ^= stan[1];
+        stan[1] ^= stan[2];
+        stan[0] ^= stan[3];
+        stan[2] ^= t;
+        stan[3] = obroc(stan[3], 45);
+        return wynik;
+    }
+
+    // [0, 1)
+    float ulamek() { return naUlamek((*this)()); }
+
+    // [a, b)
+    float przedzial(float a, float b) { return a + (b - a) * ulamek(); }
+
+    // [0, n) bez dzielenia modulo (mnożenie Lemire'a)
+    std::uint32_t calkowita(std::uint32_t n) {
+        return static_cast<std::uint32_t>(((*this)() >> 32) * n >> 32);
+    }
+
+private:
+    std::uint64_t stan[4];
+    std::uint64_t poczatkoweZiarno = 1;
+
+    static std::uint64_t obroc(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// Wypełnia wynik[i] liczbami z [a, b) wyznaczonymi przez (ziarno, od + i). Iteracje są
+// niezależne, więc pętlę można dzielić między wątki, a kompilator może ją wektoryzować.
+inline void wypelnijLicznikowo(float* wynik, std::size_t n, float a, float b,
+                               std::uint64_t ziarno, std::uint64_t od = 0) {
+    for (std::size_t i = 0; i < n; ++i) {
+        wynik[i] = a + (b - a) * naUlamek(losowaLicznikowo(ziarno, od + i));
+    }
+}
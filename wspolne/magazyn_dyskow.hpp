@@ -0,0 +1,243 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include "renderer_kol.hpp"
+#include "migawka.hpp"
+#include "porzadek_mortona.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Alokator zwracający pamięć wyrównaną do granicy rejestru AVX
+template <typename T, std::size_t Wyrownanie = 32>
+struct WyrownanyAlokator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef WyrownanyAlokator<U, Wyrownanie> other; };
+
+    WyrownanyAlokator() = default;
+    template <typename U>
+    WyrownanyAlokator(const WyrownanyAlokator<U, Wyrownanie>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Wyrownanie)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Wyrownanie));
+    }
+
+    template <typename U>
+    bool operator==(const WyrownanyAlokator<U, Wyrownanie>&) const { return true; }
+    template <typename U>
+    bool operator!=(const WyrownanyAlokator<U, Wyrownanie>&) const { return false; }
+};
+
+typedef std::vector<float, WyrownanyAlokator<float>> TablicaWyrownana;
+
+// Magazyn dysków w układzie struktury tablic: każda wielkość fizyczna w osobnej, wyrównanej tablicy.
+// Pozycja (x, y) to lewy górny róg dysku, tak jak w sf::CircleShape bez ustawionego originu.
+struct MagazynDyskow {
+    TablicaWyrownana x, y, vx, vy;
+    TablicaWyrownana masa, promien, wsp_oporu;
+    std::vector<sf::Color> kolor; // tylko do rysowania
+
+    std::size_t rozmiar() const { return x.size(); }
+
+    void dodaj(float px, float py, float pvx, float pvy, float m, float srednica, float opor, sf::Color k) {
+        x.push_back(px); y.push_back(py);
+        vx.push_back(pvx); vy.push_back(pvy);
+        masa.push_back(m);
+        promien.push_back(srednica / 2.0f);
+        wsp_oporu.push_back(opor);
+        kolor.push_back(k);
+    }
+
+    sf::Vector2f pozycja(std::size_t i) const { return sf::Vector2f(x[i], y[i]); }
+
+    // Nowa kolejność dysków: na miejsce k trafia dawny dysk kolejnosc[k]
+    void przestaw(const std::vector<std::uint32_t>& kolejnosc) {
+        ::przestaw(x, kolejnosc); ::przestaw(y, kolejnosc);
+        ::przestaw(vx, kolejnosc); ::przestaw(vy, kolejnosc);
+        ::przestaw(masa, kolejnosc);
+        ::przestaw(promien, kolejnosc);
+        ::przestaw(wsp_oporu, kolejnosc);
+        ::przestaw(kolor, kolejnosc);
+    }
+
+    // v += F * (czas / m) dla wszystkich dysków
+    void zastosujSily(const float* fx, const float* fy, float czas) {
+        zastosujSily(fx, fy, czas, 0, rozmiar());
+    }
+
+    // Opór, ruch i odbicia od krawędzi [0, szerokosc] x [0, wysokosc]
+    void zaktualizujPozycje(float czas, float szerokosc, float wysokosc) {
+        zaktualizujPozycje(czas, szerokosc, wysokosc, 0, rozmiar());
+    }
+
+    // Wersje działające na przedziale [od, do) - pozwalają dzielić pracę na bloki
+    void zastosujSily(const float* fx, const float* fy, float czas, std::size_t od, std::size_t doIndeksu) {
+        std::size_t i = od;
+#if defined(__AVX__)
+        const __m256 c = _mm256_set1_ps(czas);
+        for (; i + 8 <= doIndeksu; i += 8) {
+            __m256 s = _mm256_div_ps(c, _mm256_loadu_ps(&masa[i]));
+            _mm256_storeu_ps(&vx[i], _mm256_add_ps(_mm256_loadu_ps(&vx[i]), _mm256_mul_ps(_mm256_loadu_ps(fx + i), s)));
+            _mm256_storeu_ps(&vy[i], _mm256_add_ps(_mm256_loadu_ps(&vy[i]), _mm256_mul_ps(_mm256_loadu_ps(fy + i), s)));
+        }
+#elif defined(__SSE2__)
+        const __m128 c = _mm_set1_ps(czas);
+        for (; i + 4 <= doIndeksu; i += 4) {
+            __m128 s = _mm_div_ps(c, _mm_loadu_ps(&masa[i]));
+            _mm_storeu_ps(&vx[i], _mm_add_ps(_mm_loadu_ps(&vx[i]), _mm_mul_ps(_mm_loadu_ps(fx + i), s)));
+            _mm_storeu_ps(&vy[i], _mm_add_ps(_mm_loadu_ps(&vy[i]), _mm_mul_ps(_mm_loadu_ps(fy + i), s)));
+        }
+#endif
+        for (; i < doIndeksu; ++i) {
+            float s = czas / masa[i];
+            vx[i] = vx[i] + fx[i] * s;
+            vy[i] = vy[i] + fy[i] * s;
+        }
+    }
+
+    void zaktualizujPozycje(float czas, float szerokosc, float wysokosc, std::size_t od, std::size_t doIndeksu) {
+        std::size_t i = od;
+#if defined(__AVX__)
+        const __m256 c = _mm256_set1_ps(czas);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 dwa = _mm256_set1_ps(2.0f);
+        const __m256 znak = _mm256_set1_ps(-0.0f);
+        const __m256 w = _mm256_set1_ps(szerokosc);
+        const __m256 h = _mm256_set1_ps(wysokosc);
+        for (; i + 8 <= doIndeksu; i += 8) {
+            __m256 s = _mm256_div_ps(c, _mm256_loadu_ps(&masa[i]));
+            __m256 k = _mm256_xor_ps(_mm256_loadu_ps(&wsp_oporu[i]), znak);
+            __m256 srednica = _mm256_mul_ps(dwa, _mm256_loadu_ps(&promien[i]));
+            __m256 pvx = _mm256_loadu_ps(&vx[i]);
+            __m256 pvy = _mm256_loadu_ps(&vy[i]);
+            pvx = _mm256_add_ps(pvx, _mm256_mul_ps(_mm256_mul_ps(k, pvx), s));
+            pvy = _mm256_add_ps(pvy, _mm256_mul_ps(_mm256_mul_ps(k, pvy), s));
+            __m256 px = _mm256_add_ps(_mm256_loadu_ps(&x[i]), _mm256_mul_ps(pvx, c));
+            __m256 py = _mm256_add_ps(_mm256_loadu_ps(&y[i]), _mm256_mul_ps(pvy, c));
+
+            // Odbicia bez rozgałęzień: maski zamiast if/else
+            __m256 maksX = _mm256_sub_ps(w, srednica);
+            __m256 maksY = _mm256_sub_ps(h, srednica);
+            __m256 dolX = _mm256_cmp_ps(px, zero, _CMP_LT_OQ);
+            __m256 gorX = _mm256_andnot_ps(dolX, _mm256_cmp_ps(px, maksX, _CMP_GT_OQ));
+            __m256 dolY = _mm256_cmp_ps(py, zero, _CMP_LT_OQ);
+            __m256 gorY = _mm256_andnot_ps(dolY, _mm256_cmp_ps(py, maksY, _CMP_GT_OQ));
+            px = _mm256_blendv_ps(_mm256_blendv_ps(px, zero, dolX), maksX, gorX);
+            py = _mm256_blendv_ps(_mm256_blendv_ps(py, zero, dolY), maksY, gorY);
+            pvx = _mm256_xor_ps(pvx, _mm256_and_ps(_mm256_or_ps(dolX, gorX), znak));
+            pvy = _mm256_xor_ps(pvy, _mm256_and_ps(_mm256_or_ps(dolY, gorY), znak));
+
+            _mm256_storeu_ps(&vx[i], pvx);
+            _mm256_storeu_ps(&vy[i], pvy);
+            _mm256_storeu_ps(&x[i], px);
+            _mm256_storeu_ps(&y[i], py);
+        }
+#elif defined(__SSE2__)
+        const __m128 c = _mm_set1_ps(czas);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 dwa = _mm_set1_ps(2.0f);
+        const __m128 znak = _mm_set1_ps(-0.0f);
+        const __m128 w = _mm_set1_ps(szerokosc);
+        const __m128 h = _mm_set1_ps(wysokosc);
+        for (; i + 4 <= doIndeksu; i += 4) {
+            __m128 s = _mm_div_ps(c, _mm_loadu_ps(&masa[i]));
+            __m128 k = _mm_xor_ps(_mm_loadu_ps(&wsp_oporu[i]), znak);
+            __m128 srednica = _mm_mul_ps(dwa, _mm_loadu_ps(&promien[i]));
+            __m128 pvx = _mm_loadu_ps(&vx[i]);
+            __m128 pvy = _mm_loadu_ps(&vy[i]);
+            pvx = _mm_add_ps(pvx, _mm_mul_ps(_mm_mul_ps(k, pvx), s));
+            pvy = _mm_add_ps(pvy, _mm_mul_ps(_mm_mul_ps(k, pvy), s));
+            __m128 px = _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(pvx, c));
+            __m128 py = _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(pvy, c));
+
+            // SSE2 nie ma blendv - wybór przez and/andnot/or
+            __m128 maksX = _mm_sub_ps(w, srednica);
+            __m128 maksY = _mm_sub_ps(h, srednica);
+            __m128 dolX = _mm_cmplt_ps(px, zero);
+            __m128 gorX = _mm_andnot_ps(dolX, _mm_cmpgt_ps(px, maksX));
+            __m128 dolY = _mm_cmplt_ps(py, zero);
+            __m128 gorY = _mm_andnot_ps(dolY, _mm_cmpgt_ps(py, maksY));
+            px = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(dolX, gorX), px), _mm_and_ps(gorX, maksX));
+            py = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(dolY, gorY), py), _mm_and_ps(gorY, maksY));
+            pvx = _mm_xor_ps(pvx, _mm_and_ps(_mm_or_ps(dolX, gorX), znak));
+            pvy = _mm_xor_ps(pvy, _mm_and_ps(_mm_or_ps(dolY, gorY), znak));
+
+            _mm_storeu_ps(&vx[i], pvx);
+            _mm_storeu_ps(&vy[i], pvy);
+            _mm_storeu_ps(&x[i], px);
+            _mm_storeu_ps(&y[i], py);
+        }
+#endif
+        for (; i < doIndeksu; ++i) {
+            float s = czas / masa[i];
+            vx[i] = vx[i] + (-wsp_oporu[i] * vx[i]) * s;
+            vy[i] = vy[i] + (-wsp_oporu[i] * vy[i]) * s;
+            x[i] = x[i] + vx[i] * czas;
+            y[i] = y[i] + vy[i] * czas;
+
+            // Odbicia od krawędzi
+            float srednica = 2 * promien[i];
+            if (x[i] < 0) { x[i] = 0; vx[i] = -vx[i]; }
+            else if (x[i] > szerokosc - srednica) { x[i] = szerokosc - srednica; vx[i] = -vx[i]; }
+            if (y[i] < 0) { y[i] = 0; vy[i] = -vy[i]; }
+            else if (y[i] > wysokosc - srednica) { y[i] = wysokosc - srednica; vy[i] = -vy[i]; }
+        }
+    }
+
+    // Same odbicia od krawędzi - dla metod całkowania, które przesuwają dyski samodzielnie
+    void odbijOdKrawedzi(float szerokosc, float wysokosc, std::size_t od, std::size_t doIndeksu) {
+        for (std::size_t i = od; i < doIndeksu; ++i) {
+            float srednica = 2 * promien[i];
+            if (x[i] < 0) { x[i] = 0; vx[i] = -vx[i]; }
+            else if (x[i] > szerokosc - srednica) { x[i] = szerokosc - srednica; vx[i] = -vx[i]; }
+            if (y[i] < 0) { y[i] = 0; vy[i] = -vy[i]; }
+            else if (y[i] > wysokosc - srednica) { y[i] = wysokosc - srednica; vy[i] = -vy[i]; }
+        }
+    }
+
+    // Każda tablica jako osobny blok migawki - dane muszą żyć do ZapisMigawki::zapisz()
+    void zapisz(ZapisMigawki& zapis) const {
+        zapis.blok("dyski.x", x.data(), rozmiar());
+        zapis.blok("dyski.y", y.data(), rozmiar());
+        zapis.blok("dyski.vx", vx.data(), rozmiar());
+        zapis.blok("dyski.vy", vy.data(), rozmiar());
+        zapis.blok("dyski.masa", masa.data(), rozmiar());
+        zapis.blok("dyski.promien", promien.data(), rozmiar());
+        zapis.blok("dyski.wsp_oporu", wsp_oporu.data(), rozmiar());
+        zapis.blok("dyski.kolor", kolor.data(), rozmiar());
+    }
+
+    // false (magazyn bez zmian), gdy brakuje bloku albo tablice mają różne długości
+    bool wczytaj(const OdczytMigawki& odczyt) {
+        MagazynDyskow nowe;
+        bool ok = odczyt.wczytaj("dyski.x", nowe.x) && odczyt.wczytaj("dyski.y", nowe.y) &&
+                  odczyt.wczytaj("dyski.vx", nowe.vx) && odczyt.wczytaj("dyski.vy", nowe.vy) &&
+                  odczyt.wczytaj("dyski.masa", nowe.masa) && odczyt.wczytaj("dyski.promien", nowe.promien) &&
+                  odczyt.wczytaj("dyski.wsp_oporu", nowe.wsp_oporu) && odczyt.wczytaj("dyski.kolor", nowe.kolor);
+        std::size_t n = nowe.rozmiar();
+        if (!ok || nowe.y.size() != n || nowe.vx.size() != n || nowe.vy.size() != n || nowe.masa.size() != n ||
+            nowe.promien.size() != n || nowe.wsp_oporu.size() != n || nowe.kolor.size() != n) {
+            return false;
+        }
+        *this = std::move(nowe);
+        return true;
+    }
+
+    // Rysowanie bezpośrednio z tablic - wszystkie dyski w jednej partii renderera
+    void wypelnijRenderer(RendererKol& renderer) const {
+        renderer.zacznij(rozmiar());
+        for (std::size_t i = 0; i < rozmiar(); ++i) {
+            renderer.ustaw(i, x[i], y[i], promien[i], kolor[i]);
+        }
+    }
+};
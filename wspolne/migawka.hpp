@@ -0,0 +1,319 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MODELOWANIE_MMAP 1
+#endif
+
+#ifdef MODELOWANIE_ZLIB
+#include <zlib.h>
+#endif
+
+// Binarna migawka stanu symulacji. Plik to nagłówek i ciąg nazwanych bloków; każdy blok
+// to jedna tablica (np. wszystkie x dysków), więc układ SoA magazynów trafia na dysk bez
+// przekładania. Nagłówki i dane bloków zaczynają się na granicy 64 bajtów, dzięki czemu
+// nieskompresowany plik można zmapować do pamięci i czytać tablice wprost z mapowania.
+// Bloki mogą być skompresowane zlib (gdy program zbudowano z MODELOWANIE_ZLIB) - wtedy
+// odczyt rozpakowuje je do własnego bufora. Liczby zapisywane są w kolejności bajtów
+// maszyny; plik z maszyny o innej kolejności jest odrzucany.
+namespace migawka {
+
+const char MAGIA[8] = {'M', 'I', 'G', 'A', 'W', 'K', 'A', '\0'};
+const std::uint32_t WERSJA = 1;
+const std::uint32_t ZNACZNIK_BAJTOW = 0x01020304u;
+const std::size_t WYROWNANIE = 64;
+
+struct NaglowekPliku {
+    char magia[8];
+    std::uint32_t wersja;
+    std::uint32_t znacznikBajtow;
+    std::uint32_t liczbaBlokow;
+    std::uint32_t zarezerwowane;
+    char rodzaj[24]; // program, który zapisał migawkę - tylko informacyjnie
+    char wypelnienie[16];
+};
+
+struct NaglowekBloku {
+    char nazwa[32];
+    std::uint32_t rozmiarElementu;
+    std::uint32_t kompresja; // 0 - brak, 1 - zlib
+    std::uint64_t liczba;    // liczba elementów
+    std::uint64_t rozmiarDanych; // bajty zapisane w pliku (po kompresji)
+    std::uint64_t zarezerwowane;
+};
+
+static_assert(sizeof(NaglowekPliku) == WYROWNANIE, "nagłówek pliku musi zajmować 64 bajty");
+static_assert(sizeof(NaglowekBloku) == WYROWNANIE, "nagłówek bloku musi zajmować 64 bajty");
+
+inline std::size_t wyrownaj(std::size_t n) { return (n + WYROWNANIE - 1) / WYROWNANIE * WYROWNANIE; }
+
+} // namespace migawka
+
+// Zbieranie bloków i zapis do pliku. blok() zapamiętuje tylko wskaźnik - dane muszą żyć
+// do wywołania zapisz(); kopia() i wartosc() kopiują dane od razu.
+class ZapisMigawki {
+public:
+    explicit ZapisMigawki(const std::string& rodzaj) : rodzaj(rodzaj) {}
+
+    template <typename T>
+    void blok(const std::string& nazwa, const T* dane, std::size_t liczba) {
+        static_assert(std::is_trivially_copyable<T>::value, "blok migawki musi być kopiowalny bajtowo");
+        bloki.push_back(Blok{nazwa, sizeof(T), liczba, reinterpret_cast<const char*>(dane), -1});
+    }
+
+    template <typename T>
+    void kopia(const std::string& nazwa, const T* dane, std::size_t liczba) {
+        static_assert(std::is_trivially_copyable<T>::value, "blok migawki musi być kopiowalny bajtowo");
+        const char* bajty = reinterpret_cast<const char*>(dane);
+        kopie.emplace_back(bajty, bajty + liczba * sizeof(T));
+        bloki.push_back(Blok{nazwa, sizeof(T), liczba, nullptr, static_cast<int>(kopie.size() - 1)});
+    }
+
+    template <typename T>
+    void wartosc(const std::string& nazwa, const T& dana) {
+        kopia(nazwa, &dana, 1);
+    }
+
+    // false przy błędzie zapisu; kompresja bez zlib w buildzie jest pomijana
+    bool zapisz(const std::string& sciezka, bool kompresja = false) const {
+        std::FILE* plik = std::fopen(sciezka.c_str(), "wb");
+        if (!plik) return false;
+
+        migawka::NaglowekPliku naglowek;
+        std::memset(&naglowek, 0, sizeof(naglowek));
+        std::memcpy(naglowek.magia, migawka::MAGIA, sizeof(naglowek.magia));
+        naglowek.wersja = migawka::WERSJA;
+        naglowek.znacznikBajtow = migawka::ZNACZNIK_BAJTOW;
+        naglowek.liczbaBlokow = static_cast<std::uint32_t>(bloki.size());
+        std::strncpy(naglowek.rodzaj, rodzaj.c_str(), sizeof(naglowek.rodzaj) - 1);
+        bool ok = std::fwrite(&naglowek, sizeof(naglowek), 1, plik) == 1;
+
+        static const char zera[migawka::WYROWNANIE] = {};
+        std::vector<unsigned char> spakowane;
+        for (const auto& b : bloki) {
+            if (!ok) break;
+            const char* dane = b.kopia >= 0 ? kopie[b.kopia].data() : b.dane;
+            std::size_t rozmiar = b.rozmiarElementu * b.liczba;
+
+            migawka::NaglowekBloku nb;
+            std::memset(&nb, 0, sizeof(nb));
+            std::strncpy(nb.nazwa, b.nazwa.c_str(), sizeof(nb.nazwa) - 1);
+            nb.rozmiarElementu = static_cast<std::uint32_t>(b.rozmiarElementu);
+            nb.liczba = b.liczba;
+            nb.rozmiarDanych = rozmiar;
+#ifdef MODELOWANIE_ZLIB
+            // Blok zostaje nieskompresowany, jeśli kompresja nic nie daje
+            if (kompresja && rozmiar > 0) {
+                uLongf spakowanyRozmiar = compressBound(static_cast<uLong>(rozmiar));
+                spakowane.resize(spakowanyRozmiar);
+                if (compress2(spakowane.data(), &spakowanyRozmiar, reinterpret_cast<const Bytef*>(dane),
+                              static_cast<uLong>(rozmiar), Z_BEST_SPEED) == Z_OK && spakowanyRozmiar < rozmiar) {
+                    nb.kompresja = 1;
+                    nb.rozmiarDanych = spakowanyRozmiar;
+                    dane = reinterpret_cast<const char*>(spakowane.data());
+                }
+            }
+#else
+            (void)kompresja;
+#endif
+            std::size_t dopelnienie = migawka::wyrownaj(nb.rozmiarDanych) - nb.rozmiarDanych;
+            ok = std::fwrite(&nb, sizeof(nb), 1, plik) == 1 &&
+                 (nb.rozmiarDanych == 0 || std::fwrite(dane, nb.rozmiarDanych, 1, plik) == 1) &&
+                 (dopelnienie == 0 || std::fwrite(zera, dopelnienie, 1, plik) == 1);
+        }
+        return std::fclose(plik) == 0 && ok;
+    }
+
+private:
+    struct Blok {
+        std::string nazwa;
+        std::size_t rozmiarElementu;
+        std::size_t liczba;
+        const char* dane;
+        int kopia; // indeks w kopie albo -1
+    };
+
+    std::string rodzaj;
+    std::vector<Blok> bloki;
+    std::vector<std::vector<char>> kopie;
+};
+
+// Odczyt migawki. Plik jest mapowany do pamięci (na systemach bez mmap wczytywany w całości),
+// a blok() zwraca wskaźnik wprost do mapowania - koszt otwarcia nie zależy od liczby ciał.
+class OdczytMigawki {
+public:
+    OdczytMigawki() = default;
+    OdczytMigawki(const OdczytMigawki&) = delete;
+    OdczytMigawki& operator=(const OdczytMigawki&) = delete;
+    ~OdczytMigawki() { zamknij(); }
+
+    // false przy błędzie; opis w komunikat()
+    bool otworz(const std::string& sciezka) {
+        zamknij();
+        if (!mapuj(sciezka)) return blad("nie można odczytać pliku " + sciezka);
+        if (rozmiar < sizeof(migawka::NaglowekPliku)) return blad("plik za krótki");
+
+        migawka::NaglowekPliku naglowek;
+        std::memcpy(&naglowek, dane, sizeof(naglowek));
+        if (std::memcmp(naglowek.magia, migawka::MAGIA, sizeof(naglowek.magia)) != 0) return blad("to nie jest migawka");
+        if (naglowek.znacznikBajtow != migawka::ZNACZNIK_BAJTOW) return blad("inna kolejność bajtów");
+        if (naglowek.wersja != migawka::WERSJA) return blad("nieobsługiwana wersja " + std::to_string(naglowek.wersja));
+        naglowek.rodzaj[sizeof(naglowek.rodzaj) - 1] = '\0';
+        zapisanyRodzaj = naglowek.rodzaj;
+
+        std::size_t pozycja = sizeof(naglowek);
+        for (std::uint32_t i = 0; i < naglowek.liczbaBlokow; ++i) {
+            if (rozmiar - pozycja < sizeof(migawka::NaglowekBloku)) return blad("ucięty nagłówek bloku");
+            migawka::NaglowekBloku nb;
+            std::memcpy(&nb, dane + pozycja, sizeof(nb));
+            nb.nazwa[sizeof(nb.nazwa) - 1] = '\0';
+            pozycja += sizeof(nb);
+            if (nb.rozmiarDanych > rozmiar - pozycja) return blad(std::string("ucięty blok ") + nb.nazwa);
+            if (nb.rozmiarElementu == 0 || nb.liczba > SIZE_MAX / nb.rozmiarElementu) {
+                return blad(std::string("zły rozmiar bloku ") + nb.nazwa);
+            }
+
+            Blok b{nb.nazwa, nb.rozmiarElementu, static_cast<std::size_t>(nb.liczba), dane + pozycja};
+            std::size_t rozmiarBloku = b.rozmiarElementu * b.liczba;
+            if (nb.kompresja == 0) {
+                if (nb.rozmiarDanych != rozmiarBloku) return blad(std::string("zły rozmiar bloku ") + nb.nazwa);
+            } else {
+#ifdef MODELOWANIE_ZLIB
+                rozpakowane.emplace_back(rozmiarBloku);
+                uLongf rozpakowanyRozmiar = static_cast<uLongf>(rozmiarBloku);
+                if (uncompress(reinterpret_cast<Bytef*>(rozpakowane.back().data()), &rozpakowanyRozmiar,
+                               reinterpret_cast<const Bytef*>(b.dane), static_cast<uLong>(nb.rozmiarDanych)) != Z_OK ||
+                    rozpakowanyRozmiar != rozmiarBloku) {
+                    return blad(std::string("uszkodzony blok ") + nb.nazwa);
+                }
+                b.dane = rozpakowane.back().data();
+#else
+                return blad("migawka skompresowana, a program zbudowano bez zlib");
+#endif
+            }
+            bloki.push_back(b);
+            pozycja += migawka::wyrownaj(nb.rozmiarDanych);
+            if (pozycja > rozmiar) pozycja = rozmiar;
+        }
+        return true;
+    }
+
+    const std::string& rodzaj() const { return zapisanyRodzaj; }
+    const std::string& komunikat() const { return opisBledu; }
+
+    // Tablica z bloku albo nullptr, gdy bloku nie ma lub elementy mają inny rozmiar niż T
+    template <typename T>
+    const T* blok(const std::string& nazwa, std::size_t& liczba) const {
+        static_assert(std::is_trivially_copyable<T>::value, "blok migawki musi być kopiowalny bajtowo");
+        for (const auto& b : bloki) {
+            if (b.nazwa == nazwa && b.rozmiarElementu == sizeof(T)) {
+                liczba = b.liczba;
+                return reinterpret_cast<const T*>(b.dane);
+            }
+        }
+        liczba = 0;
+        return nullptr;
+    }
+
+    // Kopia bloku do wektora (dowolny alokator, np. wyrównany)
+    template <typename T, typename A>
+    bool wczytaj(const std::string& nazwa, std::vector<T, A>& wynik) const {
+        std::size_t liczba = 0;
+        const T* zrodlo = blok<T>(nazwa, liczba);
+        if (!zrodlo) return false;
+        wynik.resize(liczba);
+        if (liczba > 0) std::memcpy(static_cast<void*>(wynik.data()), zrodlo, liczba * sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    bool wartosc(const std::string& nazwa, T& wynik) const {
+        std::size_t liczba = 0;
+        const T* zrodlo = blok<T>(nazwa, liczba);
+        if (!zrodlo || liczba != 1) return false;
+        std::memcpy(static_cast<void*>(&wynik), zrodlo, sizeof(T));
+        return true;
+    }
+
+private:
+    struct Blok {
+        std::string nazwa;
+        std::size_t rozmiarElementu;
+        std::size_t liczba;
+        const char* dane;
+    };
+
+    const char* dane = nullptr;
+    std::size_t rozmiar = 0;
+    bool zmapowany = false;
+    std::vector<char> zawartosc; // bez mmap albo dla pustego pliku
+    std::vector<std::vector<char>> rozpakowane;
+    std::vector<Blok> bloki;
+    std::string zapisanyRodzaj;
+    std::string opisBledu;
+
+    bool blad(const std::string& opis) {
+        opisBledu = opis;
+        bloki.clear();
+        return false;
+    }
+
+    bool mapuj(const std::string& sciezka) {
+#ifdef MODELOWANIE_MMAP
+        int fd = ::open(sciezka.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        rozmiar = static_cast<std::size_t>(info.st_size);
+        if (rozmiar > 0) {
+            void* mapowanie = ::mmap(nullptr, rozmiar, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapowanie != MAP_FAILED) {
+                dane = static_cast<const char*>(mapowanie);
+                zmapowany = true;
+            }
+        }
+        ::close(fd);
+        if (zmapowany || rozmiar == 0) return true;
+#endif
+        std::FILE* plik = std::fopen(sciezka.c_str(), "rb");
+        if (!plik) return false;
+        zawartosc.clear();
+        char bufor[1 << 16];
+        std::size_t przeczytane;
+        while ((przeczytane = std::fread(bufor, 1, sizeof(bufor), plik)) > 0) {
+            zawartosc.insert(zawartosc.end(), bufor, bufor + przeczytane);
+        }
+        std::fclose(plik);
+        dane = zawartosc.data();
+        rozmiar = zawartosc.size();
+        return true;
+    }
+
+    void zamknij() {
+#ifdef MODELOWANIE_MMAP
+        if (zmapowany) ::munmap(const_cast<char*>(dane), rozmiar);
+#endif
+        zmapowany = false;
+        dane = nullptr;
+        rozmiar = 0;
+        zawartosc.clear();
+        rozpakowane.clear();
+        bloki.clear();
+        zapisanyRodzaj.clear();
+        opisBledu.clear();
+    }
+};
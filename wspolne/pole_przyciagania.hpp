@@ -0,0 +1,206 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "argumenty.hpp"
+
+// Przyciąganie do stałych punktów wypieczone w siatkę sił. Każda komórka trzyma siłę
+// w swoich czterech narożnikach, a siła wewnątrz komórki to interpolacja dwuliniowa - koszt
+// na dysk nie zależy od liczby punktów. Blisko punktu siła 1/r² zmienia się za szybko na
+// interpolację, więc punkt leżący bliżej komórki niż promienBliski() nie trafia do jej
+// narożników, tylko na listę bliskich punktów komórki liczonych dokładnie. Błąd interpolacji
+// pola 1/r² to około 1.5 * oczko² / r² jego wartości, stąd promień sqrt(1.5 / tolerancja) oczek:
+// błąd siły jednego punktu nie przekracza tolerancja razy ta siła.
+// Nowe punkty są dopisywane do siatki leniwie, w zaktualizuj(), a siatka jest budowana
+// od nowa tylko po zmianie ustawień albo wcześniejszych punktów (np. wczytaniu migawki).
+class PolePrzyciagania {
+public:
+    // Granice ustawień: drobniejsze oczko albo mniejsza tolerancja dają siatkę lub listy
+    // bliskich punktów rzędu setek MB dla okna 800x600
+    static constexpr float MIN_OCZKO = 1.0f, MAKS_OCZKO = 100.0f;
+    static constexpr float MIN_TOLERANCJA = 1e-4f, MAKS_TOLERANCJA = 0.5f;
+
+    bool wlaczone = true;
+    float tolerancja = 1e-2f;
+    float oczko = 2.0f;          // [px] bok komórki
+    std::size_t minPunktow = 8;  // przy mniejszej liczbie punktów suma dokładna jest tańsza
+
+    // Siatka pokrywa [0, szerokosc] x [0, wysokosc]; silaPunktu(pozycja, punkt) to dokładna
+    // siła jednego punktu. Przed fazą sił - sila() jest potem tylko odczytem.
+    template <typename SilaPunktu>
+    void zaktualizuj(const std::vector<sf::Vector2f>& punkty, float szerokosc, float wysokosc, SilaPunktu silaPunktu) {
+        // Ustawienia spoza granic - suma dokładna zamiast siatki, której nie da się zaalokować
+        aktywne = wlaczone && punkty.size() >= minPunktow && tolerancja >= MIN_TOLERANCJA &&
+                  tolerancja <= MAKS_TOLERANCJA && oczko >= MIN_OCZKO && oczko <= MAKS_OCZKO;
+        if (!aktywne) return;
+
+        int nx = std::max(1, static_cast<int>(std::ceil(szerokosc / oczko)));
+        int ny = std::max(1, static_cast<int>(std::ceil(wysokosc / oczko)));
+        bool zgodne = nx == kolumny && ny == wiersze && oczko == oczkoSiatki && tolerancja == tolerancjaSiatki &&
+                      wpieczone.size() <= punkty.size() &&
+                      std::equal(wpieczone.begin(), wpieczone.end(), punkty.begin());
+        if (!zgodne) {
+            kolumny = nx;
+            wiersze = ny;
+            oczkoSiatki = oczko;
+            tolerancjaSiatki = tolerancja;
+            promien = oczko * std::sqrt(1.5f / tolerancja);
+            komorki.assign(static_cast<std::size_t>(nx) * ny, Komorka());
+            bliskie.assign(komorki.size(), std::vector<std::uint32_t>());
+            wpieczone.clear();
+            ++przebudowy;
+        }
+        while (wpieczone.size() < punkty.size()) {
+            wpiecz(punkty[wpieczone.size()], static_cast<std::uint32_t>(wpieczone.size()), silaPunktu);
+            wpieczone.push_back(punkty[wpieczone.size()]);
+        }
+    }
+
+    // Siła wszystkich punktów w pozycji; poza siatką albo bez niej - suma dokładna
+    template <typename SilaPunktu>
+    sf::Vector2f sila(const sf::Vector2f& pozycja, const std::vector<sf::Vector2f>& punkty, SilaPunktu silaPunktu) const {
+        if (aktywne) {
+            float gx = pozycja.x / oczkoSiatki, gy = pozycja.y / oczkoSiatki;
+            if (gx >= 0 && gy >= 0 && gx < kolumny && gy < wiersze) {
+                int cx = static_cast<int>(gx), cy = static_cast<int>(gy);
+                float u = gx - cx, v = gy - cy;
+                std::size_t c = static_cast<std::size_t>(cy) * kolumny + cx;
+                const Komorka& k = komorki[c];
+                float w00 = (1 - u) * (1 - v), w10 = u * (1 - v), w01 = (1 - u) * v, w11 = u * v;
+                sf::Vector2f suma(w00 * k.fx[0] + w10 * k.fx[1] + w01 * k.fx[2] + w11 * k.fx[3],
+                                  w00 * k.fy[0] + w10 * k.fy[1] + w01 * k.fy[2] + w11 * k.fy[3]);
+                for (std::uint32_t p : bliskie[c]) suma += silaPunktu(pozycja, punkty[p]);
+                return suma;
+            }
+        }
+        sf::Vector2f suma(0, 0);
+        for (const auto& punkt : punkty) suma += silaPunktu(pozycja, punkt);
+        return suma;
+    }
+
+    bool uzywane() const { return aktywne; }
+    float promienBliski() const { return promien; }
+
+    struct Blad {
+        float wzglednyRMS = 0;
+        float maksWzgledny = 0; // względem sumy modułów sił punktów - ta sama miara co tolerancja
+        int probki = 0;
+    };
+
+    // Porównanie z sumą dokładną w co n / maksProbek-tej pozycji
+    template <typename SilaPunktu>
+    Blad zmierzBlad(const float* x, const float* y, std::size_t n, const std::vector<sf::Vector2f>& punkty,
+                    SilaPunktu silaPunktu, std::size_t maksProbek = 1000) const {
+        Blad blad;
+        if (n == 0) return blad;
+        std::size_t krok = std::max<std::size_t>(1, n / maksProbek);
+        double sumaBledu = 0, sumaSily = 0;
+        for (std::size_t i = 0; i < n; i += krok) {
+            sf::Vector2f pozycja(x[i], y[i]);
+            sf::Vector2f dokladna(0, 0);
+            double moduly = 0;
+            for (const auto& punkt : punkty) {
+                sf::Vector2f s = silaPunktu(pozycja, punkt);
+                dokladna += s;
+                moduly += std::sqrt(static_cast<double>(s.x) * s.x + static_cast<double>(s.y) * s.y);
+            }
+            sf::Vector2f roznica = sila(pozycja, punkty, silaPunktu) - dokladna;
+            double bladKw = static_cast<double>(roznica.x) * roznica.x + static_cast<double>(roznica.y) * roznica.y;
+            sumaBledu += bladKw;
+            sumaSily += static_cast<double>(dokladna.x) * dokladna.x + static_cast<double>(dokladna.y) * dokladna.y;
+            if (moduly > 0) blad.maksWzgledny = std::max(blad.maksWzgledny, static_cast<float>(std::sqrt(bladKw) / moduly));
+            ++blad.probki;
+        }
+        if (sumaSily > 0) blad.wzglednyRMS = static_cast<float>(std::sqrt(sumaBledu / sumaSily));
+        return blad;
+    }
+
+    void wypisz(const Blad& blad, std::size_t liczbaPunktow) const {
+        if (!aktywne) {
+            std::printf("pole przyciągania: suma dokładna (punkty = %zu)\n", liczbaPunktow);
+            return;
+        }
+        std::size_t sumaBliskich = 0;
+        for (const auto& lista : bliskie) sumaBliskich += lista.size();
+        std::printf("pole przyciągania: punkty = %zu, siatka %dx%d (oczko %g px), promień bliski = %.1f px, "
+                    "bliskie punkty na komórkę = %.2f, przebudowy = %lld\n",
+                    liczbaPunktow, kolumny, wiersze, oczkoSiatki, promien,
+                    static_cast<double>(sumaBliskich) / komorki.size(), przebudowy);
+        std::printf("błąd względem sumy dokładnej: RMS = %.2e, maks. = %.2e (tolerancja %g, %d próbek)\n",
+                    blad.wzglednyRMS, blad.maksWzgledny, tolerancjaSiatki, blad.probki);
+    }
+
+private:
+    // Narożniki w kolejności (0, 0), (1, 0), (0, 1), (1, 1)
+    struct Komorka {
+        float fx[4] = {0, 0, 0, 0};
+        float fy[4] = {0, 0, 0, 0};
+    };
+
+    bool aktywne = false;
+    int kolumny = 0, wiersze = 0;
+    float oczkoSiatki = 0, tolerancjaSiatki = 0, promien = 0;
+    std::vector<Komorka> komorki;
+    std::vector<std::vector<std::uint32_t>> bliskie;
+    std::vector<sf::Vector2f> wpieczone;
+    std::vector<sf::Vector2f> wezly; // siła wypiekanego punktu w węzłach siatki
+    long long przebudowy = 0;
+
+    // Jeden punkt: bliskim komórkom na listę, pozostałym do narożników. Siła w węźle siatki
+    // liczona jest raz i dodawana do wszystkich komórek, które go dzielą.
+    template <typename SilaPunktu>
+    void wpiecz(const sf::Vector2f& punkt, std::uint32_t indeks, SilaPunktu& silaPunktu) {
+        const float h = oczkoSiatki;
+        const int wezlyX = kolumny + 1;
+        wezly.resize(static_cast<std::size_t>(wezlyX) * (wiersze + 1));
+        for (int wy = 0; wy <= wiersze; ++wy) {
+            for (int wx = 0; wx < wezlyX; ++wx) {
+                wezly[static_cast<std::size_t>(wy) * wezlyX + wx] = silaPunktu(sf::Vector2f(wx * h, wy * h), punkt);
+            }
+        }
+        for (int cy = 0; cy < wiersze; ++cy) {
+            float y0 = cy * h;
+            float dy = std::max({0.0f, y0 - punkt.y, punkt.y - (y0 + h)});
+            for (int cx = 0; cx < kolumny; ++cx) {
+                float x0 = cx * h;
+                float dx = std::max({0.0f, x0 - punkt.x, punkt.x - (x0 + h)});
+                std::size_t c = static_cast<std::size_t>(cy) * kolumny + cx;
+                if (dx * dx + dy * dy < promien * promien) {
+                    bliskie[c].push_back(indeks);
+                    continue;
+                }
+                Komorka& k = komorki[c];
+                const sf::Vector2f* w = &wezly[static_cast<std::size_t>(cy) * wezlyX + cx];
+                const sf::Vector2f naroznik[4] = {w[0], w[1], w[wezlyX], w[wezlyX + 1]};
+                for (int n = 0; n < 4; ++n) {
+                    k.fx[n] += naroznik[n].x;
+                    k.fy[n] += naroznik[n].y;
+                }
+            }
+        }
+    }
+};
+
+// --exact-attraction, --field-tolerance TOL, --field-cell PX; false (z komunikatem na stderr),
+// gdy wartość jest spoza granic
+inline bool ustawPole(PolePrzyciagania& pole, const Argumenty& argumenty) {
+    pole.wlaczone = !argumenty.jest("exact-attraction");
+    pole.tolerancja = argumenty.liczba("field-tolerance", pole.tolerancja);
+    pole.oczko = argumenty.liczba("field-cell", pole.oczko);
+    if (!(pole.tolerancja >= PolePrzyciagania::MIN_TOLERANCJA && pole.tolerancja <= PolePrzyciagania::MAKS_TOLERANCJA)) {
+        std::fprintf(stderr, "--field-tolerance: tolerancja spoza zakresu %g..%g\n", PolePrzyciagania::MIN_TOLERANCJA,
+                     PolePrzyciagania::MAKS_TOLERANCJA);
+        return false;
+    }
+    if (!(pole.oczko >= PolePrzyciagania::MIN_OCZKO && pole.oczko <= PolePrzyciagania::MAKS_OCZKO)) {
+        std::fprintf(stderr, "--field-cell: oczko spoza zakresu %g..%g px\n", PolePrzyciagania::MIN_OCZKO,
+                     PolePrzyciagania::MAKS_OCZKO);
+        return false;
+    }
+    return true;
+}
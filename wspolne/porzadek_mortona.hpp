@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+// Kod Mortona (krzywa Z): bity dwóch 16-bitowych współrzędnych na przemian - punkty bliskie
+// w przestrzeni mają zwykle bliskie kody
+inline std::uint32_t rozsunBity(std::uint32_t v) {
+    v &= 0xffffu;
+    v = (v | (v << 8)) & 0x00ff00ffu;
+    v = (v | (v << 4)) & 0x0f0f0f0fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+inline std::uint32_t kodMortona(std::uint32_t qx, std::uint32_t qy) {
+    return rozsunBity(qx) | (rozsunBity(qy) << 1);
+}
+
+// Przestawia tablicę według permutacji: nowy element k to dawny element kolejnosc[k]
+template <typename T, typename A>
+void przestaw(std::vector<T, A>& tablica, const std::vector<std::uint32_t>& kolejnosc) {
+    std::vector<T, A> nowa;
+    nowa.reserve(kolejnosc.size());
+    for (std::uint32_t i : kolejnosc) nowa.push_back(tablica[i]);
+    tablica.swap(nowa);
+}
+
+// Okresowe porządkowanie ciał wzdłuż krzywej Mortona. Ciała powstają w losowej kolejności,
+// więc sąsiedzi w przestrzeni leżą w pamięci daleko od siebie; po posortowaniu kodów
+// pozycji przebiegi po siatce zderzeń czy drzewie sił czytają pamięć prawie sekwencyjnie.
+// Sortowanie pozycyjne (radix) po 8 bitów jest stabilne, więc remisy zachowują kolejność.
+// Identyfikatory pamiętają, które ciało z chwili utworzenia leży na danym miejscu - przez
+// nie np. trajektoria zapisuje ciała zawsze w tej samej kolejności.
+class PorzadekMortona {
+public:
+    int co = 0; // co ile kroków porządkować; 0 - nigdy
+
+    bool pora(std::uint64_t krok) const { return co > 0 && krok % static_cast<std::uint64_t>(co) == 0; }
+
+    // Permutacja porządkująca n ciał o pozycjach (x, y): na miejsce k trafia ciało kolejnosc[k]
+    const std::vector<std::uint32_t>& uporzadkuj(const float* x, const float* y, std::size_t n) {
+        kolejnosc.resize(n);
+        if (n == 0) return kolejnosc;
+        float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+        for (std::size_t i = 0; i < n; ++i) {
+            minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+            minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+        }
+        // Wspólna skala obu osi, żeby komórki krzywej były kwadratowe
+        float skala = 65535.0f / std::max({maxX - minX, maxY - minY, 1e-6f});
+        klucze.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            float qx = std::min(65535.0f, std::max(0.0f, (x[i] - minX) * skala));
+            float qy = std::min(65535.0f, std::max(0.0f, (y[i] - minY) * skala));
+            klucze[i] = kodMortona(static_cast<std::uint32_t>(qx), static_cast<std::uint32_t>(qy));
+        }
+
+        std::iota(kolejnosc.begin(), kolejnosc.end(), 0u);
+        bufor.resize(n);
+        for (int przesuniecie = 0; przesuniecie < 32; przesuniecie += 8) {
+            std::size_t poczatek[257] = {};
+            for (std::uint32_t i : kolejnosc) ++poczatek[((klucze[i] >> przesuniecie) & 0xffu) + 1];
+            for (int c = 0; c < 256; ++c) poczatek[c + 1] += poczatek[c];
+            for (std::uint32_t i : kolejnosc) bufor[poczatek[(klucze[i] >> przesuniecie) & 0xffu]++] = i;
+            kolejnosc.swap(bufor);
+        }
+
+        // Identyfikatory idą za ciałami; przy pierwszym porządkowaniu są to dotychczasowe indeksy
+        if (id.size() != n) {
+            id.resize(n);
+            std::iota(id.begin(), id.end(), 0u);
+        }
+        przestaw(id, kolejnosc);
+        ++porzadkowania;
+        return kolejnosc;
+    }
+
+    // Identyfikator ciała z miejsca i; pusty, dopóki nic nie przestawiono
+    const std::vector<std::uint32_t>& identyfikatory() const { return id; }
+
+    // Nowe ciała, wczytanie migawki - bieżąca kolejność staje się kolejnością identyfikatorów,
+    // chyba że migawka przechowała identyfikatory sprzed zapisu
+    void zresetuj(std::vector<std::uint32_t> identyfikatory = {}) { id = std::move(identyfikatory); }
+
+    // Tablica n wartości w kolejności identyfikatorów (bez przestawień - sama tablica)
+    const float* wedlugIdentyfikatorow(const float* dane, std::size_t n, std::vector<float>& wynik) const {
+        if (id.size() != n || !dane) return dane;
+        wynik.resize(n);
+        for (std::size_t i = 0; i < n; ++i) wynik[id[i]] = dane[i];
+        return wynik.data();
+    }
+
+    long long liczbaPorzadkowan() const { return porzadkowania; }
+
+private:
+    std::vector<std::uint32_t> kolejnosc, bufor, klucze, id;
+    long long porzadkowania = 0;
+};
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include "argumenty.hpp"
+
+// Profiler faz klatki. Strefy (obiekty Strefa) mierzą czas swojego zakresu i dopisują go
+// do fazy o danej nazwie; po koniecKlatki() sumy faz trafiają do bufora pierścieniowego
+// ostatnich klatek, z którego liczone są średnie do nakładki. Opcjonalnie każda strefa
+// zapisywana jest też jako zdarzenie do eksportu w formacie Chrome trace
+// (chrome://tracing, Perfetto). Wyłączony profiler kosztuje jedno sprawdzenie flagi
+// na strefę. Strefy tylko z wątku głównego.
+class Profiler {
+public:
+    static const int MAKS_FAZ = 16;
+    static const int LICZBA_KLATEK = 120;          // okno uśredniania
+    static const std::size_t MAKS_ZDARZEN = 1 << 20; // dalsze zdarzenia trace są pomijane
+
+    Profiler() : start(std::chrono::steady_clock::now()) {}
+
+    // Włączenie w trakcie klatki (np. klawiszem F3) liczy się od następnego poczatekKlatki()
+    void wlacz(bool wlacz) {
+        if (wlacz != aktywny) wKlatce = false;
+        aktywny = wlacz;
+    }
+    bool wlaczony() const { return aktywny; }
+
+    // Zapamiętywanie zdarzeń do zapiszTrace(); włącza też sam profiler
+    void nagrywaj(bool nagrywaj) {
+        nagrywanie = nagrywaj;
+        if (nagrywaj) wlacz(true);
+    }
+
+    // Mikrosekundy od utworzenia profilera
+    double teraz() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void poczatekKlatki() {
+        if (!aktywny) return;
+        std::fill(biezaca, biezaca + MAKS_FAZ, 0.0);
+        poczatekBiezacej = teraz();
+        wKlatce = true;
+    }
+
+    // Klatka bez poczatekKlatki() po włączeniu profilera jest pomijana
+    void koniecKlatki() {
+        if (!aktywny || !wKlatce) return;
+        wKlatce = false;
+        double czasKlatki = teraz() - poczatekBiezacej;
+        Klatka& k = pierscien[klatki % LICZBA_KLATEK];
+        std::copy(biezaca, biezaca + MAKS_FAZ, k.fazy);
+        k.calosc = czasKlatki;
+        for (int f = 0; f < liczba; ++f) lacznie[f] += biezaca[f];
+        laczniKlatka += czasKlatki;
+        ++klatki;
+        if (nagrywanie) zdarzenie(-1, poczatekBiezacej, czasKlatki);
+    }
+
+    // Numer fazy o tej nazwie, rejestrowanej przy pierwszym użyciu; -1, gdy faz jest za dużo.
+    // Nazwy to literały, więc zwykle wystarcza porównanie wskaźników.
+    int faza(const char* nazwa) {
+        for (int f = 0; f < liczba; ++f) {
+            if (nazwy[f] == nazwa) return f;
+        }
+        for (int f = 0; f < liczba; ++f) {
+            if (std::strcmp(nazwy[f], nazwa) == 0) return f;
+        }
+        if (liczba == MAKS_FAZ) return -1;
+        nazwy[liczba] = nazwa;
+        return liczba++;
+    }
+
+    void dodaj(int f, double poczatek, double czas) {
+        biezaca[f] += czas;
+        if (nagrywanie) zdarzenie(f, poczatek, czas);
+    }
+
+    int liczbaFaz() const { return liczba; }
+    const char* nazwa(int f) const { return nazwy[f]; }
+    std::size_t liczbaKlatek() const { return klatki; }
+
+    // Średni czas fazy na klatkę [ms] z ostatnich LICZBA_KLATEK klatek
+    double srednia(int f) const {
+        return sredniaZPierscienia([f](const Klatka& k) { return k.fazy[f]; });
+    }
+
+    double sredniaKlatki() const {
+        return sredniaZPierscienia([](const Klatka& k) { return k.calosc; });
+    }
+
+    // Podsumowanie całego przebiegu, np. po trybie wsadowym
+    void wypisz() const {
+        if (klatki == 0) return;
+        std::printf("profil (%zu klatek, %.3f ms/klatkę):", klatki, laczniKlatka / 1e3 / klatki);
+        for (int f = 0; f < liczba; ++f) std::printf(" %s = %.3f ms", nazwy[f], lacznie[f] / 1e3 / klatki);
+        std::printf("\n");
+    }
+
+    // Zdarzenia w formacie Chrome trace (JSON); false przy błędzie zapisu
+    bool zapiszTrace(const std::string& sciezka) const {
+        std::FILE* plik = std::fopen(sciezka.c_str(), "w");
+        if (!plik) return false;
+        std::fprintf(plik, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (std::size_t i = 0; i < zdarzenia.size(); ++i) {
+            const Zdarzenie& z = zdarzenia[i];
+            std::fprintf(plik, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+                         z.faza < 0 ? "klatka" : nazwy[z.faza], z.poczatek, z.czas,
+                         i + 1 < zdarzenia.size() ? "," : "");
+        }
+        std::fprintf(plik, "]}\n");
+        bool ok = !std::ferror(plik);
+        return std::fclose(plik) == 0 && ok;
+    }
+
+    std::size_t pominieteZdarzenia() const { return pominiete; }
+
+private:
+    struct Klatka {
+        double fazy[MAKS_FAZ];
+        double calosc;
+    };
+
+    struct Zdarzenie {
+        int faza; // -1 - cała klatka
+        double poczatek, czas;
+    };
+
+    std::chrono::steady_clock::time_point start;
+    bool aktywny = false;
+    bool nagrywanie = false;
+
+    const char* nazwy[MAKS_FAZ] = {};
+    int liczba = 0;
+    double biezaca[MAKS_FAZ] = {};
+    double poczatekBiezacej = 0;
+    bool wKlatce = false; // był poczatekKlatki() bez koniecKlatki()
+    Klatka pierscien[LICZBA_KLATEK] = {};
+    std::size_t klatki = 0;
+    double lacznie[MAKS_FAZ] = {};
+    double laczniKlatka = 0;
+
+    std::vector<Zdarzenie> zdarzenia;
+    std::size_t pominiete = 0;
+
+    void zdarzenie(int f, double poczatek, double czas) {
+        if (zdarzenia.size() < MAKS_ZDARZEN) zdarzenia.push_back(Zdarzenie{f, poczatek, czas});
+        else ++pominiete;
+    }
+
+    template <typename F>
+    double sredniaZPierscienia(F wartosc) const {
+        std::size_t n = std::min<std::size_t>(klatki, LICZBA_KLATEK);
+        if (n == 0) return 0;
+        double suma = 0;
+        for (std::size_t i = 0; i < n; ++i) suma += wartosc(pierscien[i]);
+        return suma / 1e3 / n;
+    }
+};
+
+// Wspólny profiler programu
+inline Profiler& profiler() {
+    static Profiler p;
+    return p;
+}
+
+// Strefa pomiaru: od konstrukcji do końca zakresu, doliczana do fazy o podanej nazwie
+class Strefa {
+public:
+    explicit Strefa(const char* nazwa) {
+        Profiler& p = profiler();
+        if (!p.wlaczony()) return;
+        faza = p.faza(nazwa);
+        poczatek = p.teraz();
+    }
+
+    ~Strefa() { zakoncz(); }
+
+    // Koniec pomiaru przed końcem zakresu - dla kolejnych faz w jednej funkcji
+    void zakoncz() {
+        if (faza < 0) return;
+        Profiler& p = profiler();
+        p.dodaj(faza, poczatek, p.teraz() - poczatek);
+        faza = -1;
+    }
+
+    Strefa(const Strefa&) = delete;
+    Strefa& operator=(const Strefa&) = delete;
+
+private:
+    int faza = -1;
+    double poczatek = 0;
+};
+
+// Nakładka ze średnimi czasami faz, liczbą ciał i wywołań draw na klatkę. Tekst jest
+// składany co kilkanaście klatek, żeby sama nakładka nie zaciemniała pomiaru.
+class NakladkaProfilera {
+public:
+    static const int CO_ILE_KLATEK = 15;
+
+    // Bez czcionki nakładka nic nie rysuje
+    explicit NakladkaProfilera(const sf::Font* czcionka) {
+        if (czcionka) {
+            tekst.setFont(*czcionka);
+            tekst.setCharacterSize(14);
+            tekst.setFillColor(sf::Color::Yellow);
+            tekst.setOutlineColor(sf::Color::Black);
+            tekst.setOutlineThickness(1.0f);
+            tekst.setPosition(10.f, 40.f);
+        }
+        maCzcionke = czcionka != nullptr;
+    }
+
+    bool widoczna = false;
+
+    // wywolania - łączna liczba wywołań draw programu (np. RendererKol::wywolania()),
+    // nakładka liczy z niej przyrost na klatkę
+    void rysuj(sf::RenderTarget& cel, std::size_t ciala, std::size_t wywolania) {
+        std::size_t naKlatke = wywolania - poprzednieWywolania;
+        poprzednieWywolania = wywolania;
+        if (!widoczna || !maCzcionke) return;
+
+        if (klatka++ % CO_ILE_KLATEK == 0) {
+            const Profiler& p = profiler();
+            char linia[128];
+            std::snprintf(linia, sizeof(linia), "klatka: %.2f ms\n", p.sredniaKlatki());
+            std::string opis = linia;
+            for (int f = 0; f < p.liczbaFaz(); ++f) {
+                std::snprintf(linia, sizeof(linia), "%s: %.2f ms\n", p.nazwa(f), p.srednia(f));
+                opis += linia;
+            }
+            // +1 za samą nakładkę
+            std::snprintf(linia, sizeof(linia), "ciała: %zu, draw: %zu", ciala, naKlatke + 1);
+            opis += linia;
+            tekst.setString(sf::String::fromUtf8(opis.begin(), opis.end()));
+        }
+        cel.draw(tekst);
+    }
+
+private:
+    sf::Text tekst;
+    bool maCzcionke = false;
+    std::size_t poprzednieWywolania = 0;
+    std::size_t klatka = 0;
+};
+
+// Wspólne opcje programów: --profile włącza profiler (w oknie także nakładkę, przełączaną
+// klawiszem F3), --trace PLIK dodatkowo zapisuje zdarzenia do pliku Chrome trace
+inline void wlaczProfiler(const Argumenty& argumenty) {
+    profiler().wlacz(argumenty.jest("profile") || argumenty.jest("trace"));
+    profiler().nagrywaj(argumenty.jest("trace"));
+}
+
+// Podsumowanie i zapis trace; false, gdy pliku nie udało się zapisać
+inline bool zakonczProfiler(const Argumenty& argumenty) {
+    const Profiler& p = profiler();
+    if (!p.wlaczony()) return true;
+    p.wypisz();
+    if (!argumenty.jest("trace")) return true;
+    std::string sciezka = argumenty.tekst("trace", "");
+    if (!p.zapiszTrace(sciezka)) {
+        std::fprintf(stderr, "%s: nie udało się zapisać trace\n", sciezka.c_str());
+        return false;
+    }
+    if (p.pominieteZdarzenia() > 0) {
+        std::fprintf(stderr, "trace: pominięto %zu zdarzeń ponad limit %zu\n", p.pominieteZdarzenia(),
+                     Profiler::MAKS_ZDARZEN);
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// Stała pula wątków do pętli równoległych. Zakres [0, n) dzielony jest na bloki,
+// które wątki pobierają dynamicznie z licznika atomowego - szybsze wątki zabierają
+// więcej bloków. Każdy blok jest liczony w całości przez jeden wątek, więc wynik
+// nie zależy od liczby wątków, o ile zadanie pisze tylko do własnego przedziału.
+class PulaWatkow {
+public:
+    explicit PulaWatkow(unsigned liczbaWatkow = std::thread::hardware_concurrency()) {
+        liczbaWatkow = std::max(1u, liczbaWatkow);
+        // Wątek wywołujący też pracuje, więc pomocników jest o jeden mniej
+        for (unsigned i = 1; i < liczbaWatkow; ++i) {
+            watki.emplace_back([this] { petlaPomocnika(); });
+        }
+    }
+
+    ~PulaWatkow() {
+        {
+            std::lock_guard<std::mutex> blokada(mutex);
+            koniec = true;
+        }
+        start.notify_all();
+        for (auto& w : watki) w.join();
+    }
+
+    PulaWatkow(const PulaWatkow&) = delete;
+    PulaWatkow& operator=(const PulaWatkow&) = delete;
+
+    unsigned liczbaWatkow() const { return static_cast<unsigned>(watki.size()) + 1; }
+
+    // Wywołuje zadanie(od, do) dla kolejnych bloków [od, do) o rozmiarze co najwyżej blok
+    void rownolegle(std::size_t n, std::size_t blok, const std::function<void(std::size_t, std::size_t)>& zadanie) {
+        if (n == 0) return;
+        blok = std::max<std::size_t>(1, blok);
+        if (watki.empty() || n <= blok) {
+            for (std::size_t od = 0; od < n; od += blok) zadanie(od, std::min(n, od + blok));
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> blokada(mutex);
+            biezace = &zadanie;
+            rozmiar = n;
+            rozmiarBloku = blok;
+            nastepnyBlok.store(0);
+            aktywni = static_cast<unsigned>(watki.size());
+            ++pokolenie;
+        }
+        start.notify_all();
+
+        wykonujBloki(zadanie, n, blok);
+
+        std::unique_lock<std::mutex> blokada(mutex);
+        gotowe.wait(blokada, [this] { return aktywni == 0; });
+        biezace = nullptr;
+    }
+
+private:
+    std::vector<std::thread> watki;
+    std::mutex mutex;
+    std::condition_variable start, gotowe;
+    const std::function<void(std::size_t, std::size_t)>* biezace = nullptr;
+    std::size_t rozmiar = 0, rozmiarBloku = 1;
+    std::atomic<std::size_t> nastepnyBlok{0};
+    unsigned aktywni = 0;
+    unsigned long long pokolenie = 0;
+    bool koniec = false;
+
+    void wykonujBloki(const std::function<void(std::size_t, std::size_t)>& zadanie, std::size_t n, std::size_t blok) {
+        for (;;) {
+            std::size_t od = nastepnyBlok.fetch_add(blok);
+            if (od >= n) break;
+            zadanie(od, std::min(n, od + blok));
+        }
+    }
+
+    void petlaPomocnika() {
+        unsigned long long widzianePokolenie = 0;
+        for (;;) {
+            const std::function<void(std::size_t, std::size_t)>* zadanie;
+            std::size_t n, blok;
+            {
+                std::unique_lock<std::mutex> blokada(mutex);
+                start.wait(blokada, [&] { return koniec || pokolenie != widzianePokolenie; });
+                if (koniec) return;
+                widzianePokolenie = pokolenie;
+                zadanie = biezace;
+                n = rozmiar;
+                blok = rozmiarBloku;
+            }
+
+            wykonujBloki(*zadanie, n, blok);
+
+            std::lock_guard<std::mutex> blokada(mutex);
+            if (--aktywni == 0) gotowe.notify_one();
+        }
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+// Renderer wsadowy kół: wszystkie koła trafiają jako czworokąty z teksturą koła
+// do jednej trwałej tablicy wierzchołków i są rysowane jednym wywołaniem draw.
+// Jeden obiekt odpowiada jednemu materiałowi (tekstura + tryb mieszania).
+class RendererKol {
+public:
+    static const unsigned ROZMIAR_TEKSTURY = 64;
+
+    explicit RendererKol(sf::BlendMode tryb = sf::BlendAlpha) : trybMieszania(tryb), wierzcholki(sf::Quads) {
+        // Tekstura koła z wygładzoną krawędzią, tworzona raz
+        sf::Image obraz;
+        obraz.create(ROZMIAR_TEKSTURY, ROZMIAR_TEKSTURY, sf::Color::Transparent);
+        float srodek = ROZMIAR_TEKSTURY / 2.0f;
+        for (unsigned y = 0; y < ROZMIAR_TEKSTURY; ++y) {
+            for (unsigned x = 0; x < ROZMIAR_TEKSTURY; ++x) {
+                float dx = x + 0.5f - srodek, dy = y + 0.5f - srodek;
+                float pokrycie = std::min(1.0f, std::max(0.0f, srodek - std::sqrt(dx * dx + dy * dy)));
+                obraz.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(255 * pokrycie)));
+            }
+        }
+        tekstura.loadFromImage(obraz);
+        tekstura.setSmooth(true);
+    }
+
+    // Ustala liczbę kół w bieżącej klatce; pamięć wierzchołków jest zachowywana między klatkami
+    void zacznij(std::size_t liczbaKol) {
+        wierzcholki.resize(4 * liczbaKol);
+    }
+
+    std::size_t liczbaKol() const { return wierzcholki.getVertexCount() / 4; }
+
+    // (x, y) to lewy górny róg kwadratu opisanego na kole, jak w sf::CircleShape
+    void ustaw(std::size_t i, float x, float y, float promien, sf::Color kolor) {
+        const float t = static_cast<float>(ROZMIAR_TEKSTURY);
+        const float d = 2 * promien;
+        sf::Vertex* q = &wierzcholki[4 * i];
+        q[0] = sf::Vertex(sf::Vector2f(x, y), kolor, sf::Vector2f(0, 0));
+        q[1] = sf::Vertex(sf::Vector2f(x + d, y), kolor, sf::Vector2f(t, 0));
+        q[2] = sf::Vertex(sf::Vector2f(x + d, y + d), kolor, sf::Vector2f(t, t));
+        q[3] = sf::Vertex(sf::Vector2f(x, y + d), kolor, sf::Vector2f(0, t));
+    }
+
+    // Dopisuje koło na końcu bieżącej partii
+    void dodaj(float x, float y, float promien, sf::Color kolor) {
+        std::size_t i = liczbaKol();
+        zacznij(i + 1);
+        ustaw(i, x, y, promien, kolor);
+    }
+
+    void rysuj(sf::RenderTarget& cel) {
+        if (wierzcholki.getVertexCount() == 0) return;
+        sf::RenderStates stan(&tekstura);
+        stan.blendMode = trybMieszania;
+        cel.draw(wierzcholki, stan);
+        ++wywolaniaRysowania;
+    }
+
+    std::size_t wywolania() const { return wywolaniaRysowania; }
+
+private:
+    sf::BlendMode trybMieszania;
+    sf::Texture tekstura;
+    sf::VertexArray wierzcholki;
+    std::size_t wywolaniaRysowania = 0;
+};
+
+// Pomiar renderowania do tekstury poza ekranem - pozwala mierzyć rysowanie bez okna
+class PomiarRenderowania {
+public:
+    bool utworz(unsigned szerokosc, unsigned wysokosc) {
+        return cel.create(szerokosc, wysokosc);
+    }
+
+    // rysujKlatke(cel) powinno zawierać clear() i wszystkie wywołania draw. Może zwrócić bool:
+    // false (klatka się nie udała) - klatka nie wchodzi do pomiaru, a klatka() zwraca false.
+    template <typename F>
+    bool klatka(F&& rysujKlatke) {
+        auto poczatek = std::chrono::steady_clock::now();
+        bool udana = true;
+        if constexpr (std::is_same<decltype(rysujKlatke(std::declval<sf::RenderTarget&>())), bool>::value) {
+            udana = rysujKlatke(static_cast<sf::RenderTarget&>(cel));
+        } else {
+            rysujKlatke(static_cast<sf::RenderTarget&>(cel));
+        }
+        if (!udana) return false;
+        cel.display();
+        sekundy += std::chrono::duration<double>(std::chrono::steady_clock::now() - poczatek).count();
+        ++klatki;
+        return true;
+    }
+
+    void wypisz(std::size_t wywolaniaRysowania) const {
+        std::printf("renderowanie poza ekranem: %.3f ms/klatkę, wywołania draw/klatkę = %.1f\n",
+                    klatki > 0 ? sekundy * 1e3 / klatki : 0.0,
+                    klatki > 0 ? static_cast<double>(wywolaniaRysowania) / klatki : 0.0);
+    }
+
+private:
+    sf::RenderTexture cel;
+    double sekundy = 0;
+    std::size_t klatki = 0;
+};
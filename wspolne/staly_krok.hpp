@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+// Harmonogram stałego kroku: czas każdej klatki trafia do akumulatora, z którego
+// zdejmowane są kroki symulacji o stałej długości. Po wolnej klatce wykonywanych jest
+// co najwyżej maksKrokow kroków, a reszta zaległego czasu jest odrzucana - symulacja
+// zwalnia zamiast wpaść w spiralę coraz dłuższych klatek.
+class StalyKrok {
+public:
+    explicit StalyKrok(double krok = 1.0 / 60.0, int maksKrokow = 5)
+        : dlugoscKroku(krok), maksKrokow(std::max(1, maksKrokow)) {}
+
+    // Dodaje czas klatki i zwraca liczbę kroków do wykonania przed rysowaniem
+    int klatka(double czasKlatki) {
+        akumulator += std::max(0.0, czasKlatki);
+        int kroki = static_cast<int>(akumulator / dlugoscKroku);
+        if (kroki > maksKrokow) {
+            odrzucony += akumulator - maksKrokow * dlugoscKroku;
+            kroki = maksKrokow;
+            akumulator = maksKrokow * dlugoscKroku;
+        }
+        akumulator -= kroki * dlugoscKroku;
+        return kroki;
+    }
+
+    float krok() const { return static_cast<float>(dlugoscKroku); }
+
+    // Część kroku zalegająca w akumulatorze, w [0, 1) - waga interpolacji przy rysowaniu
+    float alfa() const { return static_cast<float>(akumulator / dlugoscKroku); }
+
+    // Łączny czas [s] odrzucony przez limit kroków
+    double odrzuconyCzas() const { return odrzucony; }
+
+private:
+    double dlugoscKroku;
+    int maksKrokow;
+    double akumulator = 0;
+    double odrzucony = 0;
+};
+
+// Emisja wyrażona w cząsteczkach na sekundę: ułamek cząsteczki przechodzi na kolejny krok
+class LicznikEmisji {
+public:
+    explicit LicznikEmisji(double naSekunde) : naSekunde(naSekunde) {}
+
+    int ile(double czas) {
+        zalegle += naSekunde * czas;
+        // Tolerancja, żeby np. 1800/s * 1/60 s dawało 30, a nie 29 z powodu zaokrągleń
+        int n = static_cast<int>(std::floor(zalegle + 1e-9));
+        zalegle -= n;
+        return n;
+    }
+
+    double czestotliwosc() const { return naSekunde; }
+    void ustawCzestotliwosc(double wartosc) { naSekunde = wartosc; }
+
+private:
+    double naSekunde;
+    double zalegle = 0;
+};
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include "argumenty.hpp"
+
+// Zapis trajektorii do analizy po przebiegu. Plik binarny to 64-bajtowy nagłówek i ciąg
+// klatek; klatka to nagłówek (numer kroku, liczba ciał) i po jednej tablicy float na każde
+// wybrane pole, w kolejności x, y, vx, vy. Liczba ciał może się zmieniać między klatkami.
+namespace trajektoria {
+
+const char MAGIA[8] = {'T', 'R', 'A', 'J', 'E', 'K', 'T', '\0'};
+const std::uint32_t WERSJA = 1;
+const std::uint32_t ZNACZNIK_BAJTOW = 0x01020304u;
+
+enum Pole : std::uint32_t { X = 1, Y = 2, VX = 4, VY = 8, WSZYSTKIE = 15 };
+const int LICZBA_POL = 4;
+const char* const NAZWY_POL[LICZBA_POL] = {"x", "y", "vx", "vy"};
+
+struct NaglowekPliku {
+    char magia[8];
+    std::uint32_t wersja;
+    std::uint32_t znacznikBajtow;
+    std::uint32_t pola;
+    std::uint32_t co;        // zapisywany co który krok
+    float krokCzasu;         // [s] - czas klatki to numer kroku razy krokCzasu
+    char wypelnienie[36];
+};
+
+struct NaglowekKlatki {
+    std::uint64_t krok;
+    std::uint32_t liczbaCial;
+    std::uint32_t pola;
+};
+
+static_assert(sizeof(NaglowekPliku) == 64, "nagłówek trajektorii musi zajmować 64 bajty");
+static_assert(sizeof(NaglowekKlatki) == 16, "nagłówek klatki musi zajmować 16 bajtów");
+
+// "x,y,vx,vy" (dowolny podzbiór) na maskę pól; false przy nieznanej nazwie
+inline bool parsujPola(const std::string& opis, std::uint32_t& pola) {
+    pola = 0;
+    std::size_t poczatek = 0;
+    while (poczatek <= opis.size()) {
+        std::size_t przecinek = opis.find(',', poczatek);
+        if (przecinek == std::string::npos) przecinek = opis.size();
+        std::string nazwa = opis.substr(poczatek, przecinek - poczatek);
+        int p = 0;
+        while (p < LICZBA_POL && nazwa != NAZWY_POL[p]) ++p;
+        if (p == LICZBA_POL) return false;
+        pola |= 1u << p;
+        poczatek = przecinek + 1;
+    }
+    return pola != 0;
+}
+
+} // namespace trajektoria
+
+// Zapis strumieniowy z podwójnym buforem: pętla symulacji dopisuje klatki do bieżącego
+// bufora, a po przekroczeniu progu oddaje go wątkowi zapisu i pisze dalej do drugiego.
+// Jeśli wątek jeszcze nie skończył poprzedniego bufora, bieżący po prostu rośnie -
+// symulacja nigdy nie czeka na dysk, co najwyżej zajmuje więcej pamięci.
+class ZapisTrajektorii {
+public:
+    // Próg przekazania bufora wątkowi zapisu [B]
+    static const std::size_t PROG_BUFORA = 4u << 20;
+
+    ZapisTrajektorii() = default;
+    ZapisTrajektorii(const ZapisTrajektorii&) = delete;
+    ZapisTrajektorii& operator=(const ZapisTrajektorii&) = delete;
+    ~ZapisTrajektorii() { zamknij(); }
+
+    bool otworz(const std::string& sciezka, std::uint32_t pola = trajektoria::WSZYSTKIE, std::uint32_t co = 1,
+                float krokCzasu = 0) {
+        zamknij();
+        plik = std::fopen(sciezka.c_str(), "wb");
+        if (!plik) return false;
+        this->pola = pola & trajektoria::WSZYSTKIE;
+        this->co = co > 0 ? co : 1;
+
+        trajektoria::NaglowekPliku naglowek;
+        std::memset(&naglowek, 0, sizeof(naglowek));
+        std::memcpy(naglowek.magia, trajektoria::MAGIA, sizeof(naglowek.magia));
+        naglowek.wersja = trajektoria::WERSJA;
+        naglowek.znacznikBajtow = trajektoria::ZNACZNIK_BAJTOW;
+        naglowek.pola = this->pola;
+        naglowek.co = this->co;
+        naglowek.krokCzasu = krokCzasu;
+        bladZapisu = std::fwrite(&naglowek, sizeof(naglowek), 1, plik) != 1;
+        bajty = sizeof(naglowek);
+        klatki = powiekszenia = 0;
+        koniec = false;
+        watek = std::thread([this] { petlaZapisu(); });
+        return !bladZapisu;
+    }
+
+    bool otwarty() const { return plik != nullptr; }
+
+    // Czy krok o tym numerze trafi do pliku - pozwala pominąć zbieranie danych
+    bool zapisze(std::uint64_t krok) const { return plik && krok % co == 0; }
+
+    // Klatka z tablic SoA; tablice niewybranych pól mogą być nullptr
+    void krok(std::uint64_t numer, std::size_t n, const float* x, const float* y, const float* vx, const float* vy) {
+        if (!zapisze(numer)) return;
+        trajektoria::NaglowekKlatki naglowek{numer, static_cast<std::uint32_t>(n), pola};
+        dopisz(&naglowek, sizeof(naglowek));
+        const float* tablice[trajektoria::LICZBA_POL] = {x, y, vx, vy};
+        for (int p = 0; p < trajektoria::LICZBA_POL; ++p) {
+            if (pola & (1u << p)) dopisz(tablice[p], n * sizeof(float));
+        }
+        ++klatki;
+        if (biezacy.size() >= PROG_BUFORA) przekaz(false);
+    }
+
+    // Dopisuje resztę danych i czeka na wątek zapisu; false, jeśli któryś zapis się nie udał
+    bool zamknij() {
+        if (!plik) return true;
+        if (!biezacy.empty()) przekaz(true);
+        {
+            std::lock_guard<std::mutex> blokada(mutex);
+            koniec = true;
+        }
+        zadanie.notify_one();
+        watek.join();
+        bool ok = std::fclose(plik) == 0 && !bladZapisu;
+        plik = nullptr;
+        return ok;
+    }
+
+    std::uint64_t liczbaKlatek() const { return klatki; }
+    std::uint64_t liczbaBajtow() const { return bajty; }
+    // Ile razy bufor musiał rosnąć, bo wątek zapisu nie nadążał
+    std::uint64_t liczbaPowiekszen() const { return powiekszenia; }
+
+private:
+    std::FILE* plik = nullptr;
+    std::uint32_t pola = trajektoria::WSZYSTKIE;
+    std::uint32_t co = 1;
+    std::uint64_t klatki = 0, bajty = 0, powiekszenia = 0;
+
+    std::vector<char> biezacy;  // pisany przez pętlę symulacji
+    std::vector<char> doZapisu; // pisany na dysk przez wątek; pusty, gdy wątek jest wolny
+    std::thread watek;
+    std::mutex mutex;
+    std::condition_variable zadanie, gotowy;
+    bool koniec = false;
+    bool bladZapisu = false;
+
+    void dopisz(const void* dane, std::size_t rozmiar) {
+        const char* bajtyDanych = static_cast<const char*>(dane);
+        biezacy.insert(biezacy.end(), bajtyDanych, bajtyDanych + rozmiar);
+        bajty += rozmiar;
+    }
+
+    void przekaz(bool czekaj) {
+        std::unique_lock<std::mutex> blokada(mutex);
+        if (!doZapisu.empty()) {
+            if (!czekaj) {
+                ++powiekszenia;
+                return;
+            }
+            gotowy.wait(blokada, [this] { return doZapisu.empty(); });
+        }
+        // Pusty bufor po poprzednim zapisie wraca do pętli razem ze swoją pojemnością
+        doZapisu.swap(biezacy);
+        zadanie.notify_one();
+    }
+
+    void petlaZapisu() {
+        std::unique_lock<std::mutex> blokada(mutex);
+        for (;;) {
+            zadanie.wait(blokada, [this] { return !doZapisu.empty() || koniec; });
+            if (doZapisu.empty()) return;
+            blokada.unlock();
+            bool ok = std::fwrite(doZapisu.data(), doZapisu.size(), 1, plik) == 1;
+            blokada.lock();
+            if (!ok) bladZapisu = true;
+            doZapisu.clear();
+            gotowy.notify_all();
+        }
+    }
+};
+
+// Eksport pliku trajektorii do CSV (krok,czas,cialo,<pola>) - dla małych przebiegów,
+// np. do arkusza lub pandas. false przy błędzie odczytu lub zapisu.
+inline bool eksportujTrajektorieCsv(const std::string& wejscie, const std::string& wyjscie) {
+    std::FILE* we = std::fopen(wejscie.c_str(), "rb");
+    if (!we) return false;
+    trajektoria::NaglowekPliku naglowek;
+    if (std::fread(&naglowek, sizeof(naglowek), 1, we) != 1 ||
+        std::memcmp(naglowek.magia, trajektoria::MAGIA, sizeof(naglowek.magia)) != 0 ||
+        naglowek.znacznikBajtow != trajektoria::ZNACZNIK_BAJTOW || naglowek.wersja != trajektoria::WERSJA) {
+        std::fclose(we);
+        return false;
+    }
+    std::FILE* wy = std::fopen(wyjscie.c_str(), "w");
+    if (!wy) {
+        std::fclose(we);
+        return false;
+    }
+
+    std::fprintf(wy, "krok,czas,cialo");
+    for (int p = 0; p < trajektoria::LICZBA_POL; ++p) {
+        if (naglowek.pola & (1u << p)) std::fprintf(wy, ",%s", trajektoria::NAZWY_POL[p]);
+    }
+    std::fprintf(wy, "\n");
+
+    bool ok = true;
+    trajektoria::NaglowekKlatki klatka;
+    std::vector<float> wartosci[trajektoria::LICZBA_POL];
+    while (ok && std::fread(&klatka, sizeof(klatka), 1, we) == 1) {
+        for (int p = 0; p < trajektoria::LICZBA_POL && ok; ++p) {
+            if (!(klatka.pola & (1u << p))) continue;
+            wartosci[p].resize(klatka.liczbaCial);
+            ok = klatka.liczbaCial == 0 ||
+                 std::fread(wartosci[p].data(), sizeof(float), klatka.liczbaCial, we) == klatka.liczbaCial;
+        }
+        double czas = static_cast<double>(klatka.krok) * naglowek.krokCzasu;
+        for (std::uint32_t i = 0; ok && i < klatka.liczbaCial; ++i) {
+            std::fprintf(wy, "%llu,%g,%u", static_cast<unsigned long long>(klatka.krok), czas, i);
+            for (int p = 0; p < trajektoria::LICZBA_POL; ++p) {
+                if (klatka.pola & (1u << p)) std::fprintf(wy, ",%.9g", wartosci[p][i]);
+            }
+            std::fprintf(wy, "\n");
+        }
+    }
+    ok = ok && !std::ferror(we);
+    std::fclose(we);
+    return std::fclose(wy) == 0 && ok;
+}
+
+// Wspólne opcje programów: --trajectory PLIK [--every N] [--fields x,y,vx,vy] [--csv PLIK].
+// true, gdy zapis nie był żądany albo plik otwarto; błąd jest wypisywany na stderr.
+inline bool otworzTrajektorie(ZapisTrajektorii& zapis, const Argumenty& argumenty, float krokCzasu) {
+    if (!argumenty.jest("trajectory")) return true;
+    std::uint32_t pola = trajektoria::WSZYSTKIE;
+    if (argumenty.jest("fields") && !trajektoria::parsujPola(argumenty.tekst("fields", ""), pola)) {
+        std::fprintf(stderr, "--fields: oczekiwano listy pól spośród x,y,vx,vy\n");
+        return false;
+    }
+    std::string sciezka = argumenty.tekst("trajectory", "");
+    long long co = argumenty.liczbaCalkowita("every", 1);
+    if (!zapis.otworz(sciezka, pola, static_cast<std::uint32_t>(co > 0 ? co : 1), krokCzasu)) {
+        std::fprintf(stderr, "%s: nie udało się otworzyć pliku trajektorii\n", sciezka.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Zamknięcie, podsumowanie i opcjonalny eksport do CSV
+inline bool zakonczTrajektorie(ZapisTrajektorii& zapis, const Argumenty& argumenty) {
+    if (!zapis.otwarty()) return true;
+    std::string sciezka = argumenty.tekst("trajectory", "");
+    if (!zapis.zamknij()) {
+        std::fprintf(stderr, "%s: błąd zapisu trajektorii\n", sciezka.c_str());
+        return false;
+    }
+    std::printf("trajektoria: klatki = %llu, MB = %.2f, powiększenia bufora = %llu\n",
+                static_cast<unsigned long long>(zapis.liczbaKlatek()), zapis.liczbaBajtow() / 1048576.0,
+                static_cast<unsigned long long>(zapis.liczbaPowiekszen()));
+    if (argumenty.jest("csv") && !eksportujTrajektorieCsv(sciezka, argumenty.tekst("csv", ""))) {
+        std::fprintf(stderr, "%s: nie udało się wyeksportować trajektorii do CSV\n", sciezka.c_str());
+        return false;
+    }
+    return true;
+}
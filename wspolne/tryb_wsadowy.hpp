@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+// Suma kontrolna stanu (FNV-1a po bitach liczb) - pozwala porównywać przebiegi między commitami
+class SumaKontrolna {
+public:
+    void dodaj(const float* dane, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) dodaj(dane[i]);
+    }
+
+    void dodaj(float wartosc) {
+        std::uint32_t bity;
+        std::memcpy(&bity, &wartosc, sizeof(bity));
+        for (int k = 0; k < 4; ++k) {
+            hasz ^= (bity >> (8 * k)) & 0xffu;
+            hasz *= 1099511628211ull;
+        }
+    }
+
+    std::uint64_t wartosc() const { return hasz; }
+
+private:
+    std::uint64_t hasz = 14695981039346656037ull;
+};
+
+// Pomiar przebiegu bez okna: liczba kroków, kroki ciał i czas ściany
+class PomiarWsadowy {
+public:
+    void start() { poczatek = std::chrono::steady_clock::now(); }
+    void stop() { koniec = std::chrono::steady_clock::now(); }
+
+    // Po każdym kroku: ile ciał zostało w nim przeliczonych
+    void krok(std::size_t liczbaCial) {
+        ++kroki;
+        krokiCial += liczbaCial;
+    }
+
+    double sekundy() const { return std::chrono::duration<double>(koniec - poczatek).count(); }
+    std::uint64_t liczbaKrokowCial() const { return krokiCial; }
+
+    void wypisz(const char* nazwa, std::uint64_t suma) const {
+        double s = sekundy();
+        std::printf("%s: kroki = %llu, kroki/s = %.1f, ns/(ciało*krok) = %.2f, suma kontrolna = %016llx\n",
+                    nazwa, static_cast<unsigned long long>(kroki), s > 0 ? kroki / s : 0.0,
+                    krokiCial > 0 ? s * 1e9 / static_cast<double>(krokiCial) : 0.0,
+                    static_cast<unsigned long long>(suma));
+    }
+
+private:
+    std::chrono::steady_clock::time_point poczatek, koniec;
+    std::uint64_t kroki = 0;
+    std::uint64_t krokiCial = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Pamięć podręczna zasobów: czcionki wczytywane są raz i potem wydawane
+// przez wskaźnik. Nieudane wczytanie też jest zapamiętywane, więc brak pliku kosztuje
+// jedną próbę zamiast próby w każdej klatce. Pliki szukane są w katalogu bieżącym
+// i w katalogu programu, żeby działało uruchamianie spoza build/zadanie_N/.
+class Zasoby {
+public:
+    explicit Zasoby(const std::string& sciezkaProgramu = "") {
+        katalogi.push_back("");
+        std::string::size_type ukosnik = sciezkaProgramu.find_last_of("/\\");
+        if (ukosnik != std::string::npos) katalogi.push_back(sciezkaProgramu.substr(0, ukosnik + 1));
+    }
+
+    Zasoby(const Zasoby&) = delete;
+    Zasoby& operator=(const Zasoby&) = delete;
+
+    // nullptr, gdy pliku nie udało się wczytać z żadnego katalogu
+    const sf::Font* czcionka(const std::string& nazwa) {
+        return wczytaj(czcionki, nazwa);
+    }
+
+private:
+    std::vector<std::string> katalogi;
+    // unique_ptr - sf::Text trzyma wskaźnik do czcionki, więc jej adres nie może się zmieniać
+    std::map<std::string, std::unique_ptr<sf::Font>> czcionki;
+
+    template <typename T>
+    const T* wczytaj(std::map<std::string, std::unique_ptr<T>>& pamiec, const std::string& nazwa) {
+        auto it = pamiec.find(nazwa);
+        if (it != pamiec.end()) return it->second.get();
+
+        std::unique_ptr<T> zasob(new T());
+        bool wczytany = false;
+        for (const auto& katalog : katalogi) {
+            if (zasob->loadFromFile(katalog + nazwa)) {
+                wczytany = true;
+                break;
+            }
+        }
+        if (!wczytany) zasob.reset();
+        return pamiec.emplace(nazwa, std::move(zasob)).first->second.get();
+    }
+};
@@ -2,6 +2,24 @@
 #include <vector>
 #include <cmath>
 #include <random>
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <utility>
+#include "grawitacja.hpp"
+#include "kroki_blokowe.hpp"
+#include "../wspolne/pula_watkow.hpp"
+#include "../wspolne/argumenty.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/tryb_wsadowy.hpp"
+#include "../wspolne/trajektoria.hpp"
+#include "../wspolne/profiler.hpp"
+#include "../wspolne/zasoby.hpp"
+#include "../wspolne/calkowanie.hpp"
+#include "../wspolne/porzadek_mortona.hpp"
+#include "../wspolne/liczniki_sprzetowe.hpp"
+#include "../wspolne/pole_przyciagania.hpp"
 
 const int szerokosc_okna = 800;
 const int wysokosc_okna = 600;
@@ -10,118 +28,436 @@ const float czas = 0.01f;
 const float G = 100.0f; // Stała przyciągania
 const sf::Vector2f SRODEK(szerokosc_okna / 2.0f, wysokosc_okna / 2.0f);
 
-// Struktura Dysku
-struct Dysk {
-    sf::CircleShape ksztalt;
-    sf::Vector2f v;
-    float masa;
-    float wsp_oporu;
+// Opór zależny od położenia początkowego dysku
+float wspolczynnikOporu(float y) {
+    return 0.01f + (y / wysokosc_okna) * 0.05f; // Wartość oporu zmienia się z pozycją
+}
+
+// Siła jednego punktu przyciągania - dokładna, do sumy i do wypiekania pola
+const auto silaPunktu = [](const sf::Vector2f& pozycja, const sf::Vector2f& punkt) {
+    return silaPrzyciagania(pozycja, punkt, G);
+};
 
-    Dysk(float x, float y, float vx, float vy, float m, float srednica, sf::Color kolor)
-        : v(vx, vy), masa(m) {
-        ksztalt.setRadius(srednica / 2.0f);
-        ksztalt.setFillColor(kolor);
-        ksztalt.setPosition(x, y);
-        wsp_oporu = 0.01f + (y / wysokosc_okna) * 0.05f; // Wartość oporu zmienia się z pozycją
+// Generowanie liczb losowych; bez --seed w oknie ziarno pochodzi z std::random_device
+GeneratorLosowy gen(std::random_device{}());
+const float min_srednica = 10.0f;
+const float maks_srednica = 40.0f;
+
+sf::Color losujKolor() {
+    return sf::Color(gen.calkowita(256), gen.calkowita(256), gen.calkowita(256));
+}
+
+// Rozmiar bloku dysków przydzielanego jednemu wątkowi (wielokrotność szerokości wektora)
+const std::size_t rozmiar_bloku = 256;
+
+// Stan symulacji wraz z jednym krokiem - wspólny dla trybu okienkowego i wsadowego
+struct Symulacja {
+    MagazynDyskow dyski;
+    std::vector<sf::Vector2f> punktyPrzyciagania{SRODEK};
+    // Przy wielu punktach ich siła z siatki zamiast sumy po punktach
+    PolePrzyciagania pole;
+    DrzewoKwadrantowe drzewo;
+    Calkownik calkownik;
+    // Indywidualne kroki dysków zamiast wspólnego kroku całkownika (--block-steps)
+    KrokiBlokowe krokiBlokowe;
+    bool blokowe = false;
+    bool barnesHut = true;
+    float theta = 0.7f;
+    // Dyski porządkowane wzdłuż krzywej Mortona co porzadek.co kroków (--reorder)
+    PorzadekMortona porzadek;
+    std::uint64_t wykonaneKroki = 0;
+
+    void utworzDyski(int liczbaDyskow) {
+        for (int i = 0; i < liczbaDyskow; ++i) {
+            float x = gen.przedzial(0, szerokosc_okna - 2 * 50);
+            float y = gen.przedzial(0, wysokosc_okna - 2 * 50);
+            float vx = gen.przedzial(-50, 50);
+            float vy = gen.przedzial(-50, 50);
+            float masa = gen.przedzial(1.0f, 5.0f);
+            float srednica = gen.przedzial(min_srednica, maks_srednica);
+            sf::Color kolor = losujKolor();
+            dyski.dodaj(x, y, vx, vy, masa, srednica, wspolczynnikOporu(y), kolor);
+        }
+    }
+
+    // Dodatkowe punkty przyciągania w losowych miejscach okna (--points)
+    void dodajLosowePunkty(int liczba) {
+        for (int i = 0; i < liczba; ++i) {
+            float x = gen.przedzial(0, szerokosc_okna);
+            float y = gen.przedzial(0, wysokosc_okna);
+            punktyPrzyciagania.emplace_back(x, y);
+        }
     }
 
-    void zastosujSile(const sf::Vector2f& F) {
-        v += F * (czas / masa);
+    void krok(PulaWatkow& pula) {
+        if (porzadek.pora(wykonaneKroki++)) uporzadkuj();
+        {
+            // Punkty dodane od poprzedniego kroku trafiają do siatki
+            Strefa strefa("pole");
+            pole.zaktualizuj(punktyPrzyciagania, szerokosc_okna, wysokosc_okna, silaPunktu);
+        }
+        if (blokowe) {
+            krokiBlokowe.krok(
+                dyski, calkownik.dt, szerokosc_okna, wysokosc_okna,
+                [&](const int* indeksy, std::size_t liczba, float* silyX, float* silyY) {
+                    obliczSily(indeksy, liczba, silyX, silyY, pula);
+                },
+                [&](std::size_t n, const std::function<void(std::size_t, std::size_t)>& zadanie) {
+                    Strefa strefa("calkowanie");
+                    pula.rownolegle(n, rozmiar_bloku, zadanie);
+                });
+            return;
+        }
+        calkownik.krok(
+            dyski, szerokosc_okna, wysokosc_okna,
+            [&](const MagazynDyskow& stan, float* silyX, float* silyY) { obliczSily(stan, silyX, silyY, pula); },
+            [&](std::size_t n, const std::function<void(std::size_t, std::size_t)>& zadanie) {
+                // Faza całkowania: wektorowo, blokami niezależnych dysków
+                Strefa strefa("calkowanie");
+                pula.rownolegle(n, rozmiar_bloku, zadanie);
+            });
     }
 
-    void zaktualizujPozycje() {
-        sf::Vector2f opor = -wsp_oporu * v;  // Opór proporcjonalny do prędkości
-        zastosujSile(opor);
-        ksztalt.move(v * czas);
+    // Siły dla pozycji ze stanu - samego magazynu albo stanu pośredniego metody całkowania
+    void obliczSily(const MagazynDyskow& stan, float* silyX, float* silyY, PulaWatkow& pula) {
+        {
+            Strefa strefa("drzewo");
+            drzewo.zbuduj(stan);
+        }
+
+        // Faza sił: tylko odczyt stanu z początku kroku, każdy wątek pisze wyłącznie swój blok sił.
+        // Suma dla jednego dysku jest zawsze liczona w tej samej kolejności przez jeden wątek,
+        // więc wynik jest identyczny bitowo niezależnie od liczby wątków.
+        Strefa strefa("sily");
+        if (!barnesHut) {
+            pula.rownolegle(stan.rozmiar(), rozmiar_bloku, [&](std::size_t od, std::size_t doIndeksu) {
+                for (size_t i = od; i < doIndeksu; ++i) {
+                    sf::Vector2f silaCalkowita = silaDysku(stan, static_cast<int>(i));
+                    silyX[i] = silaCalkowita.x;
+                    silyY[i] = silaCalkowita.y;
+                }
+            });
+            return;
+        }
 
-        // Odbicia od krawędzi
-        sf::Vector2f pozycja = ksztalt.getPosition();
-        if (pozycja.x < 0) { pozycja.x = 0; v.x *= -1; }
-        else if (pozycja.x > szerokosc_okna - 2 * ksztalt.getRadius()) { pozycja.x = szerokosc_okna - 2 * ksztalt.getRadius(); v.x *= -1; }
-        if (pozycja.y < 0) { pozycja.y = 0; v.y *= -1; }
-        else if (pozycja.y > wysokosc_okna - 2 * ksztalt.getRadius()) { pozycja.y = wysokosc_okna - 2 * ksztalt.getRadius(); v.y *= -1; }
-        ksztalt.setPosition(pozycja);
+        // Barnes-Hut liśćmi drzewa - liść należy do jednego bloku, a jego dyski do jednego liścia
+        pula.rownolegle(drzewo.liczbaLisci(), rozmiar_bloku / DrzewoKwadrantowe::POJEMNOSC_LISCIA,
+                        [&](std::size_t od, std::size_t doLiscia) {
+                            DrzewoKwadrantowe::ListaOddzialywan lista;
+                            for (std::size_t l = od; l < doLiscia; ++l) drzewo.silyLiscia(l, theta, G, lista, silyX, silyY);
+                        });
+        pula.rownolegle(stan.rozmiar(), rozmiar_bloku, [&](std::size_t od, std::size_t doIndeksu) {
+            for (size_t i = od; i < doIndeksu; ++i) {
+                sf::Vector2f sila = pole.sila(stan.pozycja(i), punktyPrzyciagania, silaPunktu);
+                silyX[i] += sila.x;
+                silyY[i] += sila.y;
+            }
+        });
     }
-};
 
-// Siła przyciągająca do centrum lub innych punktów
-sf::Vector2f silaPrzyciagania(const sf::Vector2f& pozycja, const sf::Vector2f& punkt, float intensywnosc) {
-    sf::Vector2f kierunek = punkt - pozycja;
-    float odleglosc = std::sqrt(kierunek.x * kierunek.x + kierunek.y * kierunek.y);
-    if (odleglosc < 1.0f) odleglosc = 1.0f;
-    kierunek /= odleglosc;
-    return kierunek * (intensywnosc / (odleglosc * odleglosc));
-}
+    // Siły tylko dla wybranych dysków (kroki blokowe); drzewo obejmuje wszystkie dyski
+    void obliczSily(const int* indeksy, std::size_t liczba, float* silyX, float* silyY, PulaWatkow& pula) {
+        {
+            Strefa strefa("drzewo");
+            drzewo.zbuduj(dyski);
+        }
+        Strefa strefa("sily");
+        pula.rownolegle(liczba, rozmiar_bloku, [&](std::size_t od, std::size_t doIndeksu) {
+            for (std::size_t k = od; k < doIndeksu; ++k) {
+                sf::Vector2f silaCalkowita = silaDysku(dyski, indeksy[k]);
+                silyX[k] = silaCalkowita.x;
+                silyY[k] = silaCalkowita.y;
+            }
+        });
+    }
 
-// Generowanie liczb losowych
-std::random_device rd;
-std::mt19937 gen(rd());
-std::uniform_real_distribution<> dis(-50, 50);
-std::uniform_real_distribution<> posX(0, szerokosc_okna - 2 * 50);
-std::uniform_real_distribution<> posY(0, wysokosc_okna - 2 * 50);
-std::uniform_real_distribution<> rozkladMas(1.0, 5.0);
-std::uniform_real_distribution<> rozkladSrednicy(10.0, 40.0);
-std::uniform_int_distribution<> kolor(0, 255);
+    sf::Vector2f silaDysku(const MagazynDyskow& stan, int i) const {
+        sf::Vector2f silaCalkowita(0, 0);
 
-sf::Color losujKolor() {
-    return sf::Color(kolor(gen), kolor(gen), kolor(gen));
-}
+        // Przyciąganie do każdego punktu
+        silaCalkowita += pole.sila(stan.pozycja(i), punktyPrzyciagania, silaPunktu);
 
-int main() {
-    sf::RenderWindow okno(sf::VideoMode(szerokosc_okna, wysokosc_okna), "Rozszerzona Symulacja Dysków");
-    std::vector<Dysk> dyski;
-    std::vector<sf::Vector2f> punktyPrzyciagania{SRODEK};
+        // Przyciąganie między dyskami
+        if (barnesHut) {
+            silaCalkowita += drzewo.sila(i, stan, theta, G);
+        } else {
+            silaCalkowita += silaBezposrednia(i, stan, G);
+        }
+        return silaCalkowita;
+    }
 
-    for (int i = 0; i < ilosc_dyskow; ++i) {
-        float x = posX(gen);
-        float y = posY(gen);
-        float vx = dis(gen);
-        float vy = dis(gen);
-        float masa = rozkladMas(gen);
-        float srednica = rozkladSrednicy(gen);
-        sf::Color kolor = losujKolor();
-        dyski.emplace_back(x, y, vx, vy, masa, srednica, kolor);
+    // Dyski bliskie w przestrzeni obok siebie w pamięci; siły i szczeble zapamiętane
+    // między krokami idą za dyskami
+    void uporzadkuj() {
+        Strefa strefa("porzadek");
+        const std::vector<std::uint32_t>& kolejnosc = porzadek.uporzadkuj(dyski.x.data(), dyski.y.data(), dyski.rozmiar());
+        dyski.przestaw(kolejnosc);
+        calkownik.przestaw(kolejnosc);
+        krokiBlokowe.przestaw(kolejnosc);
     }
 
-    while (okno.isOpen()) {
-        sf::Event event;
-        while (okno.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) okno.close();
-            else if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f nowyPunkt(event.mouseButton.x, event.mouseButton.y);
-                    punktyPrzyciagania.push_back(nowyPunkt); // Dodaj nowy punkt przyciągania
-                }
-            }
+    // Siły zapamiętane między krokami są nieaktualne
+    void uniewaznij() {
+        calkownik.uniewaznij();
+        krokiBlokowe.uniewaznij();
+    }
+
+    // Energia i pęd do pomiaru dryfu metody całkowania (O(N²))
+    BilansEnergii bilans() const {
+        BilansEnergii wynik = bilansRuchu(dyski);
+        wynik.potencjalna = energiaPotencjalna(dyski, punktyPrzyciagania, G);
+        return wynik;
+    }
+
+    // Wszystkie dyski jednym wywołaniem draw
+    void rysuj(sf::RenderTarget& cel, RendererKol& renderer) const {
+        cel.clear();
+        dyski.wypelnijRenderer(renderer);
+        renderer.rysuj(cel);
+    }
+
+    // Migawka: dyski i punkty przyciągania; błędy są wypisywane na stderr
+    bool zapisz(const std::string& sciezka, bool kompresja) const {
+        ZapisMigawki zapis("zadanie_3");
+        dyski.zapisz(zapis);
+        zapis.blok("punkty", punktyPrzyciagania.data(), punktyPrzyciagania.size());
+        // Faza porządkowania i identyfikatory - wznowiony przebieg porządkuje w tych samych krokach
+        zapis.wartosc("kroki", wykonaneKroki);
+        zapis.blok("identyfikatory", porzadek.identyfikatory().data(), porzadek.identyfikatory().size());
+        if (zapis.zapisz(sciezka, kompresja)) return true;
+        std::fprintf(stderr, "%s: nie udało się zapisać migawki\n", sciezka.c_str());
+        return false;
+    }
+
+    bool wczytaj(const std::string& sciezka) {
+        OdczytMigawki odczyt;
+        if (!odczyt.otworz(sciezka)) {
+            std::fprintf(stderr, "%s: %s\n", sciezka.c_str(), odczyt.komunikat().c_str());
+            return false;
+        }
+        if (!dyski.wczytaj(odczyt)) {
+            std::fprintf(stderr, "%s: migawka nie zawiera kompletnych dysków\n", sciezka.c_str());
+            return false;
         }
+        // Punkty są opcjonalne - migawka z innego programu może ich nie mieć
+        if (!odczyt.wczytaj("punkty", punktyPrzyciagania)) punktyPrzyciagania.assign(1, SRODEK);
+        // Bez kroków i identyfikatorów (starsza migawka) porządkowanie zaczyna się od nowa
+        std::vector<std::uint32_t> identyfikatory;
+        if (!odczyt.wczytaj("identyfikatory", identyfikatory) || identyfikatory.size() != dyski.rozmiar()) {
+            identyfikatory.clear();
+        }
+        porzadek.zresetuj(std::move(identyfikatory));
+        if (!odczyt.wartosc("kroki", wykonaneKroki)) wykonaneKroki = 0;
+        uniewaznij();
+        return true;
+    }
+
+    std::uint64_t sumaKontrolna() const {
+        SumaKontrolna suma;
+        suma.dodaj(dyski.x.data(), dyski.rozmiar());
+        suma.dodaj(dyski.y.data(), dyski.rozmiar());
+        suma.dodaj(dyski.vx.data(), dyski.rozmiar());
+        suma.dodaj(dyski.vy.data(), dyski.rozmiar());
+        return suma.wartosc();
+    }
+};
+
+std::string tytulOkna(const Symulacja& sym) {
+    // Przy krokach blokowych liczebności szczebli od najdłuższego kroku
+    std::string metoda = sym.blokowe ? "szczeble: " + sym.krokiBlokowe.opisLiczebnosci()
+                                     : std::string(nazwaMetody(sym.calkownik.metoda));
+    if (!sym.barnesHut) return "Rozszerzona Symulacja Dysków [suma dokładna, " + metoda + "]";
+    return "Rozszerzona Symulacja Dysków [Barnes-Hut, theta = " + std::to_string(sym.theta).substr(0, 4) + ", " +
+           metoda + "]";
+}
+
+// Uruchomienie: disk_simulation [--disks N | --load PLIK] [--save PLIK [--compress]] [--theta T] [--threads N]
+//                                [--exact] [--seed S] [--headless KROKI [--render KLATKI]]
+//                                [--trajectory PLIK [--every N] [--fields x,y,vx,vy] [--csv PLIK]]
+//                                [--profile] [--trace PLIK]
+//                                [--integrator euler|leapfrog|rk4] [--dt KROK] [--no-drag] [--energy]
+//                                [--block-steps [MAKS_SZCZEBEL] [--eta ETA]] [--reorder KROKI] [--cache-misses]
+//                                [--points N] [--field-tolerance TOL] [--field-cell PX] [--exact-attraction]
+int main(int argc, char* argv[]) {
+    Argumenty argumenty(argc, argv);
+    wlaczProfiler(argumenty);
+    // Bez --seed okno losuje ziarno, a tryb wsadowy bierze 1 - jak zadanie_5 i zadanie_6
+    if (argumenty.jest("seed") || argumenty.jest("headless")) {
+        gen.seed(static_cast<std::uint64_t>(argumenty.liczbaCalkowita("seed", 1)));
+    }
+    LicznikiSprzetowe liczniki;
+    wlaczLiczniki(liczniki, argumenty);
+
+    PulaWatkow pula(static_cast<unsigned>(argumenty.liczbaCalkowita("threads", std::thread::hardware_concurrency())));
+    Symulacja sym;
+    sym.theta = argumenty.liczba("theta", sym.theta);
+    sym.barnesHut = !argumenty.jest("exact");
+    if (!ustawCalkownik(sym.calkownik, argumenty, czas)) return 1;
+    // --block-steps: krok dysku dt / 2^r, r <= MAKS_SZCZEBEL, dobierany z przyspieszenia
+    sym.blokowe = argumenty.jest("block-steps");
+    sym.krokiBlokowe.maksSzczebel = static_cast<int>(argumenty.liczbaCalkowita("block-steps", sym.krokiBlokowe.maksSzczebel));
+    sym.krokiBlokowe.eta = argumenty.liczba("eta", sym.krokiBlokowe.eta);
+    sym.porzadek.co = static_cast<int>(argumenty.liczbaCalkowita("reorder", 0));
+    // Pole przyciągania: dopuszczalny błąd siły punktu względem sumy dokładnej i bok komórki
+    if (!ustawPole(sym.pole, argumenty)) return 1;
+    if (sym.krokiBlokowe.maksSzczebel < 0 || sym.krokiBlokowe.maksSzczebel >= KrokiBlokowe::MAKS_SZCZEBLI) {
+        std::fprintf(stderr, "--block-steps: szczebel spoza zakresu 0..%d\n", KrokiBlokowe::MAKS_SZCZEBLI - 1);
+        return 1;
+    }
+    // --load: stan z migawki zamiast losowych dysków; --save: zapis po przebiegu wsadowym
+    // albo klawiszem F5 w oknie (F9 wczytuje ponownie)
+    const std::string plikZapisu = argumenty.tekst("save", "zadanie_3.migawka");
+    const std::string plikOdczytu = argumenty.tekst("load", plikZapisu);
+    const bool kompresja = argumenty.jest("compress");
+    if (argumenty.jest("load")) {
+        if (!sym.wczytaj(plikOdczytu)) return 1;
+    } else {
+        sym.utworzDyski(static_cast<int>(argumenty.liczbaCalkowita("disks", ilosc_dyskow)));
+    }
+    sym.dodajLosowePunkty(static_cast<int>(argumenty.liczbaCalkowita("points", 0)));
+    // --no-drag: bez oporu energia powinna być zachowana - do porównania dryfu metod
+    if (argumenty.jest("no-drag")) sym.dyski.wsp_oporu.assign(sym.dyski.rozmiar(), 0.0f);
+
+    // Trajektoria: stan początkowy jako krok 0, potem stan po każdym kroku. Dyski zapisywane są
+    // w kolejności identyfikatorów, więc porządkowanie nie zmienia numerów ciał w pliku.
+    ZapisTrajektorii trajektoria;
+    if (!otworzTrajektorie(trajektoria, argumenty, sym.calkownik.dt)) return 1;
+    std::uint64_t krokSymulacji = 0;
+    std::vector<float> kolumny[4];
+    auto zapiszKrok = [&] {
+        if (!trajektoria.zapisze(krokSymulacji)) return;
+        const MagazynDyskow& d = sym.dyski;
+        const std::size_t n = d.rozmiar();
+        trajektoria.krok(krokSymulacji, n, sym.porzadek.wedlugIdentyfikatorow(d.x.data(), n, kolumny[0]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.y.data(), n, kolumny[1]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.vx.data(), n, kolumny[2]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.vy.data(), n, kolumny[3]));
+    };
+    zapiszKrok();
 
-        // Aktualizacja sił i pozycji
-        for (auto& dysk : dyski) {
-            sf::Vector2f silaCalkowita(0, 0);
+    // Tryb wsadowy: stała liczba kroków bez otwierania okna
+    if (argumenty.jest("headless")) {
+        long long kroki = argumenty.liczbaCalkowita("headless", 1000);
+        // --energy: bilans przed i po przebiegu; energia potencjalna liczona parami, O(N²)
+        const bool bilans = argumenty.jest("energy");
+        BilansEnergii poczatek;
+        if (bilans) poczatek = sym.bilans();
+        PomiarWsadowy pomiar;
+        pomiar.start();
+        liczniki.start();
+        for (long long k = 0; k < kroki; ++k) {
+            profiler().poczatekKlatki();
+            sym.krok(pula);
+            ++krokSymulacji;
+            zapiszKrok();
+            profiler().koniecKlatki();
+            pomiar.krok(sym.dyski.rozmiar());
+        }
+        liczniki.stop();
+        pomiar.stop();
+        std::printf("dyski = %zu, wątki = %u, %s\n", sym.dyski.rozmiar(), pula.liczbaWatkow(),
+                    sym.barnesHut ? "Barnes-Hut" : "suma dokładna");
+        if (sym.blokowe) sym.krokiBlokowe.wypisz();
+        else wypiszKosztCalkowania(sym.calkownik, kroki);
+        if (bilans) wypiszDryf(poczatek, sym.bilans());
+        if (sym.porzadek.co > 0) {
+            std::printf("porządek Mortona: co %d kroków, porządkowania = %lld\n", sym.porzadek.co,
+                        sym.porzadek.liczbaPorzadkowan());
+        }
+        if (argumenty.jest("cache-misses")) liczniki.wypisz(static_cast<double>(pomiar.liczbaKrokowCial()));
+        if (sym.barnesHut) {
+            BladSily blad = zmierzBladSily(sym.drzewo, sym.dyski, sym.theta, G, !sym.blokowe);
+            std::printf("Barnes-Hut (theta = %g): błąd siły względem sumy dokładnej RMS = %.2e, maks. = %.2e (%d próbek)\n",
+                        sym.theta, blad.wzglednyRMS, blad.maksWzgledny, blad.probki);
+        }
+        if (sym.pole.uzywane()) {
+            sym.pole.wypisz(sym.pole.zmierzBlad(sym.dyski.x.data(), sym.dyski.y.data(), sym.dyski.rozmiar(),
+                                                sym.punktyPrzyciagania, silaPunktu),
+                            sym.punktyPrzyciagania.size());
+        }
+        pomiar.wypisz("zadanie_3", sym.sumaKontrolna());
+        if (!zakonczTrajektorie(trajektoria, argumenty) || !zakonczProfiler(argumenty)) return 1;
+        if (argumenty.jest("save") && !sym.zapisz(plikZapisu, kompresja)) return 1;
 
-            // Przyciąganie do każdego punktu
-            for (const auto& punkt : punktyPrzyciagania) {
-                silaCalkowita += silaPrzyciagania(dysk.ksztalt.getPosition(), punkt, G);
+        // --render N: dodatkowo N klatek rysowanych do tekstury poza ekranem
+        if (argumenty.jest("render")) {
+            RendererKol renderer;
+            PomiarRenderowania pomiarRenderowania;
+            if (!pomiarRenderowania.utworz(szerokosc_okna, wysokosc_okna)) return 1;
+            long long klatki = argumenty.liczbaCalkowita("render", 100);
+            for (long long k = 0; k < klatki; ++k) {
+                pomiarRenderowania.klatka([&](sf::RenderTarget& cel) { sym.rysuj(cel, renderer); });
             }
+            pomiarRenderowania.wypisz(renderer.wywolania());
+        }
+        return 0;
+    }
 
-            // Przyciąganie między dyskami
-            for (const auto& inny : dyski) {
-                if (&dysk != &inny) {
-                    silaCalkowita += silaPrzyciagania(dysk.ksztalt.getPosition(), inny.ksztalt.getPosition(), G * dysk.masa * inny.masa);
+    std::cout << "Wątki: " << pula.liczbaWatkow() << "\n";
+    sf::RenderWindow okno(sf::VideoMode(szerokosc_okna, wysokosc_okna), tytulOkna(sym));
+    RendererKol renderer;
+    Zasoby zasoby(argv[0]);
+    NakladkaProfilera nakladka(zasoby.czcionka("arial.ttf"));
+    nakladka.widoczna = profiler().wlaczony();
+    int klatka = 0;
+
+    while (okno.isOpen()) {
+        profiler().poczatekKlatki();
+        {
+            Strefa strefa("zdarzenia");
+            sf::Event event;
+            while (okno.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) okno.close();
+                else if (event.type == sf::Event::MouseButtonPressed) {
+                    if (event.mouseButton.button == sf::Mouse::Left) {
+                        sf::Vector2f nowyPunkt(event.mouseButton.x, event.mouseButton.y);
+                        sym.punktyPrzyciagania.push_back(nowyPunkt); // Dodaj nowy punkt przyciągania
+                        sym.uniewaznij();
+                    }
+                }
+                else if (event.type == sf::Event::KeyPressed) {
+                    // B - przełączanie Barnes-Hut / suma dokładna, [ ] - zmiana theta, E - pomiar błędu siły,
+                    // F5 / F9 - zapis / odczyt migawki, F3 - nakładka profilera, I - zmiana metody całkowania
+                    if (event.key.code == sf::Keyboard::B) sym.barnesHut = !sym.barnesHut;
+                    else if (event.key.code == sf::Keyboard::F5) sym.zapisz(plikZapisu, kompresja);
+                    else if (event.key.code == sf::Keyboard::F9) sym.wczytaj(plikOdczytu);
+                    else if (event.key.code == sf::Keyboard::F3) {
+                        profiler().wlacz(true);
+                        nakladka.widoczna = !nakladka.widoczna;
+                    }
+                    else if (event.key.code == sf::Keyboard::I) sym.calkownik.metoda = nastepnaMetoda(sym.calkownik.metoda);
+                    else if (event.key.code == sf::Keyboard::LBracket) sym.theta = std::max(0.0f, sym.theta - 0.1f);
+                    else if (event.key.code == sf::Keyboard::RBracket) sym.theta += 0.1f;
+                    else if (event.key.code == sf::Keyboard::E) {
+                        BladSily blad = zmierzBladSily(sym.drzewo, sym.dyski, sym.theta, G, !sym.blokowe);
+                        std::cout << "theta = " << sym.theta << ": błąd względny RMS = " << blad.wzglednyRMS
+                                  << ", maks. = " << blad.maksWzgledny << " (" << blad.probki << " próbek)\n";
+                    }
+                    // Przybliżenie sił albo metoda mogły się zmienić
+                    sym.uniewaznij();
+                    okno.setTitle(tytulOkna(sym));
                 }
             }
-
-            dysk.zastosujSile(silaCalkowita);
-            dysk.zaktualizujPozycje();
         }
 
+        sym.krok(pula);
+        ++krokSymulacji;
+        zapiszKrok();
+        if (sym.blokowe && ++klatka % 30 == 0) okno.setTitle(tytulOkna(sym));
+
         // Renderowanie
-        okno.clear();
-        for (const auto& dysk : dyski) {
-            okno.draw(dysk.ksztalt);
+        {
+            Strefa strefa("rysowanie");
+            sym.rysuj(okno, renderer);
+            nakladka.rysuj(okno, sym.dyski.rozmiar(), renderer.wywolania());
+        }
+        {
+            Strefa strefa("display");
+            okno.display();
         }
-        okno.display();
+        profiler().koniecKlatki();
     }
 
-    return 0;
+    bool ok = zakonczTrajektorie(trajektoria, argumenty);
+    return zakonczProfiler(argumenty) && ok ? 0 : 1;
 }
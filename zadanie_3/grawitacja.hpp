@@ -0,0 +1,342 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "../wspolne/magazyn_dyskow.hpp"
+#include "../wspolne/calkowanie.hpp"
+
+// Siła przyciągająca do centrum lub innych punktów
+inline sf::Vector2f silaPrzyciagania(const sf::Vector2f& pozycja, const sf::Vector2f& punkt, float intensywnosc) {
+    sf::Vector2f kierunek = punkt - pozycja;
+    float odleglosc = std::sqrt(kierunek.x * kierunek.x + kierunek.y * kierunek.y);
+    if (odleglosc < 1.0f) odleglosc = 1.0f;
+    kierunek /= odleglosc;
+    return kierunek * (intensywnosc / (odleglosc * odleglosc));
+}
+
+// Dokładna suma O(N) sił od wszystkich pozostałych dysków (tryb referencyjny)
+inline sf::Vector2f silaBezposrednia(int i, const MagazynDyskow& dyski, float G) {
+    sf::Vector2f sila(0, 0);
+    sf::Vector2f pozycja = dyski.pozycja(i);
+    for (int j = 0; j < static_cast<int>(dyski.rozmiar()); ++j) {
+        if (j != i) {
+            sila += silaPrzyciagania(pozycja, dyski.pozycja(j), G * dyski.masa[i] * dyski.masa[j]);
+        }
+    }
+    return sila;
+}
+
+// Energia potencjalna układu: wszystkie pary dysków (O(N²), tylko do pomiaru dryfu)
+// i przyciąganie do punktów, które nie zależy od masy dysku
+inline double energiaPotencjalna(const MagazynDyskow& dyski, const std::vector<sf::Vector2f>& punkty, float G) {
+    double energia = 0;
+    int n = static_cast<int>(dyski.rozmiar());
+    for (int i = 0; i < n; ++i) {
+        for (const auto& punkt : punkty) energia += potencjalPrzyciagania(dyski.pozycja(i), punkt, G);
+        for (int j = i + 1; j < n; ++j) {
+            energia += potencjalPrzyciagania(dyski.pozycja(i), dyski.pozycja(j), G * dyski.masa[i] * dyski.masa[j]);
+        }
+    }
+    return energia;
+}
+
+// Drzewo czwórkowe Barnesa-Huta: odległe grupy dysków zastępowane są ich środkiem masy
+class DrzewoKwadrantowe {
+public:
+    // Maksymalna głębokość - dyski o (prawie) identycznych pozycjach trafiają do wspólnego liścia
+    static const int MAKS_GLEBOKOSC = 24;
+    // Liczba dysków w liściu, po przekroczeniu której liść jest dzielony
+    static const int POJEMNOSC_LISCIA = 16;
+    // Dyski liścia liczone razem w silyLiscia()
+    static const int PACZKA = 8;
+
+    void zbuduj(const MagazynDyskow& dyski) {
+        int n = static_cast<int>(dyski.rozmiar());
+        wezly.clear();
+        liscie.clear();
+        nastepny.assign(n, -1);
+        if (n == 0) return;
+
+        // Kwadratowy obszar obejmujący wszystkie dyski
+        float minX = dyski.x[0], maxX = dyski.x[0];
+        float minY = dyski.y[0], maxY = dyski.y[0];
+        for (int i = 0; i < n; ++i) {
+            minX = std::min(minX, dyski.x[i]); maxX = std::max(maxX, dyski.x[i]);
+            minY = std::min(minY, dyski.y[i]); maxY = std::max(maxY, dyski.y[i]);
+        }
+        float rozmiar = std::max(maxX - minX, maxY - minY) * 1.0001f + 1.0f;
+
+        wezly.reserve(n * 2);
+        wezly.push_back(Wezel{minX, minY, rozmiar});
+        for (int i = 0; i < n; ++i) {
+            wstaw(i, dyski);
+        }
+
+        // Dyski z każdego liścia układamy obok siebie, żeby przejście po drzewie czytało pamięć sekwencyjnie
+        ciala.clear();
+        ciala.reserve(n);
+        uporzadkuj(0, dyski);
+
+        // Dzieci mają zawsze większe indeksy niż rodzic, więc wystarczy przejść od końca
+        for (int n = static_cast<int>(wezly.size()) - 1; n >= 0; --n) {
+            Wezel& w = wezly[n];
+            float masa = 0, sx = 0, sy = 0;
+            if (w.pierwszeDziecko < 0) {
+                for (int k = w.cialo; k < w.cialo + w.liczba; ++k) {
+                    masa += ciala[k].masa;
+                    sx += ciala[k].masa * ciala[k].pozycja.x;
+                    sy += ciala[k].masa * ciala[k].pozycja.y;
+                }
+            } else {
+                for (int k = 0; k < 4; ++k) {
+                    const Wezel& d = wezly[w.pierwszeDziecko + k];
+                    masa += d.masa;
+                    sx += d.masa * d.srodekMasy.x;
+                    sy += d.masa * d.srodekMasy.y;
+                }
+            }
+            w.masa = masa;
+            if (masa > 0) w.srodekMasy = sf::Vector2f(sx / masa, sy / masa);
+        }
+    }
+
+    // Siła działająca na dysk i; theta to kąt otwarcia (0 = suma dokładna)
+    sf::Vector2f sila(int i, const MagazynDyskow& dyski, float theta, float G) const {
+        sf::Vector2f wynik(0, 0);
+        if (wezly.empty()) return wynik;
+
+        const sf::Vector2f p = dyski.pozycja(i);
+        const float masa = dyski.masa[i];
+        int stos[4 * MAKS_GLEBOKOSC + 4];
+        int wierzcholek = 0;
+        stos[wierzcholek++] = 0;
+        while (wierzcholek > 0) {
+            const Wezel& w = wezly[stos[--wierzcholek]];
+            if (w.masa <= 0) continue;
+
+            if (w.pierwszeDziecko < 0) {
+                for (int k = w.cialo; k < w.cialo + w.liczba; ++k) {
+                    if (ciala[k].indeks != i) wynik += silaPrzyciagania(p, ciala[k].pozycja, G * masa * ciala[k].masa);
+                }
+                continue;
+            }
+
+            // Węzeł zawierający sam dysk zawsze jest otwierany
+            bool wewnatrz = p.x >= w.minX && p.x < w.minX + w.rozmiar &&
+                            p.y >= w.minY && p.y < w.minY + w.rozmiar;
+            sf::Vector2f d = w.srodekMasy - p;
+            if (!wewnatrz && w.rozmiar * w.rozmiar < theta * theta * (d.x * d.x + d.y * d.y)) {
+                wynik += silaPrzyciagania(p, w.srodekMasy, G * masa * w.masa);
+            } else {
+                for (int k = 0; k < 4; ++k) stos[wierzcholek++] = w.pierwszeDziecko + k;
+            }
+        }
+        return wynik;
+    }
+
+    // Oddziaływania wspólne dla dysków jednego liścia: środki masy odległych węzłów i dyski
+    // z liści bliskich (razem z samym liściem - dysk nie działa na siebie, bo r = 0)
+    struct ListaOddzialywan {
+        std::vector<float> x, y, masa;
+    };
+
+    // Liście z co najmniej jednym dyskiem, do podziału faz sił między wątki
+    std::size_t liczbaLisci() const { return liscie.size(); }
+
+    // Siły na wszystkie dyski liścia: jedno przejście drzewa na liść zamiast na dysk. Węzeł jest
+    // przybliżany, gdy kryterium theta spełnia odległość od prostokąta obejmującego dyski liścia,
+    // więc przybliżenie jest co najmniej tak dokładne jak w sila(). Siły trafiają pod indeksy dysków.
+    void silyLiscia(std::size_t l, float theta, float G, ListaOddzialywan& lista, float* silyX, float* silyY) const {
+        const Wezel& lisc = wezly[liscie[l]];
+        float minX = ciala[lisc.cialo].pozycja.x, maxX = minX;
+        float minY = ciala[lisc.cialo].pozycja.y, maxY = minY;
+        for (int k = lisc.cialo; k < lisc.cialo + lisc.liczba; ++k) {
+            minX = std::min(minX, ciala[k].pozycja.x); maxX = std::max(maxX, ciala[k].pozycja.x);
+            minY = std::min(minY, ciala[k].pozycja.y); maxY = std::max(maxY, ciala[k].pozycja.y);
+        }
+
+        lista.x.clear();
+        lista.y.clear();
+        lista.masa.clear();
+        int stos[4 * MAKS_GLEBOKOSC + 4];
+        int wierzcholek = 0;
+        stos[wierzcholek++] = 0;
+        while (wierzcholek > 0) {
+            const Wezel& w = wezly[stos[--wierzcholek]];
+            if (w.masa <= 0) continue;
+
+            if (w.pierwszeDziecko < 0) {
+                for (int k = w.cialo; k < w.cialo + w.liczba; ++k) {
+                    lista.x.push_back(ciala[k].pozycja.x);
+                    lista.y.push_back(ciala[k].pozycja.y);
+                    lista.masa.push_back(ciala[k].masa);
+                }
+                continue;
+            }
+
+            // Węzeł nachodzący na prostokąt liścia zawsze jest otwierany
+            float dx = std::max({0.0f, minX - w.srodekMasy.x, w.srodekMasy.x - maxX});
+            float dy = std::max({0.0f, minY - w.srodekMasy.y, w.srodekMasy.y - maxY});
+            bool nachodzi = maxX >= w.minX && minX < w.minX + w.rozmiar &&
+                            maxY >= w.minY && minY < w.minY + w.rozmiar;
+            if (!nachodzi && w.rozmiar * w.rozmiar < theta * theta * (dx * dx + dy * dy)) {
+                lista.x.push_back(w.srodekMasy.x);
+                lista.y.push_back(w.srodekMasy.y);
+                lista.masa.push_back(w.masa);
+            } else {
+                for (int k = 0; k < 4; ++k) stos[wierzcholek++] = w.pierwszeDziecko + k;
+            }
+        }
+
+        // Po PACZKA dysków naraz: pętla wewnętrzna po dyskach paczki nie ma zależności
+        // między iteracjami i kompilator liczy ją wektorowo
+        const std::size_t m = lista.x.size();
+        const float* lx = lista.x.data();
+        const float* ly = lista.y.data();
+        const float* lm = lista.masa.data();
+        for (int poczatek = lisc.cialo; poczatek < lisc.cialo + lisc.liczba; poczatek += PACZKA) {
+            const int liczba = std::min(PACZKA, lisc.cialo + lisc.liczba - poczatek);
+            float px[PACZKA], py[PACZKA], fx[PACZKA] = {}, fy[PACZKA] = {};
+            for (int b = 0; b < PACZKA; ++b) {
+                const Cialo& c = ciala[poczatek + std::min(b, liczba - 1)];
+                px[b] = c.pozycja.x;
+                py[b] = c.pozycja.y;
+            }
+            for (std::size_t j = 0; j < m; ++j) {
+                for (int b = 0; b < PACZKA; ++b) {
+                    float dx = lx[j] - px[b], dy = ly[j] - py[b];
+                    float r = std::max(std::sqrt(dx * dx + dy * dy), 1.0f);
+                    float s = lm[j] / (r * r * r);
+                    fx[b] += dx * s;
+                    fy[b] += dy * s;
+                }
+            }
+            for (int b = 0; b < liczba; ++b) {
+                const Cialo& c = ciala[poczatek + b];
+                silyX[c.indeks] = G * c.masa * fx[b];
+                silyY[c.indeks] = G * c.masa * fy[b];
+            }
+        }
+    }
+
+    std::size_t liczbaWezlow() const { return wezly.size(); }
+
+private:
+    struct Wezel {
+        float minX, minY, rozmiar;
+        float masa = 0;
+        sf::Vector2f srodekMasy = sf::Vector2f(0, 0);
+        int pierwszeDziecko = -1; // cztery kolejne węzły, -1 dla liścia
+        int cialo = -1;           // w trakcie budowy: lista po tablicy nastepny, potem: początek w tablicy ciala
+        int liczba = 0;
+    };
+
+    struct Cialo {
+        sf::Vector2f pozycja;
+        float masa;
+        int indeks;
+    };
+
+    std::vector<Wezel> wezly;
+    std::vector<int> nastepny;
+    std::vector<Cialo> ciala;
+    std::vector<int> liscie;
+
+    void uporzadkuj(int n, const MagazynDyskow& dyski) {
+        if (wezly[n].pierwszeDziecko >= 0) {
+            for (int k = 0; k < 4; ++k) uporzadkuj(wezly[n].pierwszeDziecko + k, dyski);
+            return;
+        }
+        int poczatek = static_cast<int>(ciala.size());
+        for (int b = wezly[n].cialo; b >= 0; b = nastepny[b]) {
+            ciala.push_back(Cialo{dyski.pozycja(b), dyski.masa[b], b});
+        }
+        wezly[n].cialo = poczatek;
+        if (wezly[n].liczba > 0) liscie.push_back(n);
+    }
+
+    static int cwiartka(const Wezel& w, float x, float y) {
+        float polowa = w.rozmiar * 0.5f;
+        return (x >= w.minX + polowa ? 1 : 0) + (y >= w.minY + polowa ? 2 : 0);
+    }
+
+    void wstaw(int b, const MagazynDyskow& dyski) {
+        int n = 0;
+        for (int glebokosc = 0;; ++glebokosc) {
+            if (wezly[n].pierwszeDziecko >= 0) {
+                n = wezly[n].pierwszeDziecko + cwiartka(wezly[n], dyski.x[b], dyski.y[b]);
+                continue;
+            }
+            if (wezly[n].liczba < POJEMNOSC_LISCIA || glebokosc >= MAKS_GLEBOKOSC) {
+                nastepny[b] = wezly[n].cialo;
+                wezly[n].cialo = b;
+                ++wezly[n].liczba;
+                return;
+            }
+
+            // Podział pełnego liścia - dotychczasowe dyski przenosimy do odpowiednich ćwiartek
+            int stary = wezly[n].cialo;
+            float polowa = wezly[n].rozmiar * 0.5f;
+            float x = wezly[n].minX, y = wezly[n].minY;
+            int pierwsze = static_cast<int>(wezly.size());
+            wezly.push_back(Wezel{x, y, polowa});
+            wezly.push_back(Wezel{x + polowa, y, polowa});
+            wezly.push_back(Wezel{x, y + polowa, polowa});
+            wezly.push_back(Wezel{x + polowa, y + polowa, polowa});
+            wezly[n].cialo = -1;
+            wezly[n].liczba = 0;
+            wezly[n].pierwszeDziecko = pierwsze;
+            while (stary >= 0) {
+                int kolejny = nastepny[stary];
+                Wezel& dziecko = wezly[pierwsze + cwiartka(wezly[n], dyski.x[stary], dyski.y[stary])];
+                nastepny[stary] = dziecko.cialo;
+                dziecko.cialo = stary;
+                ++dziecko.liczba;
+                stary = kolejny;
+            }
+            n = pierwsze + cwiartka(wezly[n], dyski.x[b], dyski.y[b]);
+        }
+    }
+};
+
+// Błąd przybliżenia względem sumy dokładnej (na próbce co najwyżej maksProbek dysków)
+struct BladSily {
+    float wzglednyRMS = 0;
+    float maksWzgledny = 0;
+    int probki = 0;
+};
+
+// Drzewo jest budowane od nowa z dyski - drzewo z kroku mogło powstać ze stanu pośredniego
+// metody całkowania albo sprzed uporządkowania dysków. liscmi: siły z silyLiscia(), jak w pełnym
+// kroku, inaczej z sila() dla pojedynczego dysku, jak w krokach blokowych.
+inline BladSily zmierzBladSily(DrzewoKwadrantowe& drzewo, const MagazynDyskow& dyski,
+                               float theta, float G, bool liscmi, int maksProbek = 1000) {
+    BladSily blad;
+    int n = static_cast<int>(dyski.rozmiar());
+    if (n == 0) return blad;
+    drzewo.zbuduj(dyski);
+    std::vector<float> silyX, silyY;
+    if (liscmi) {
+        silyX.resize(n);
+        silyY.resize(n);
+        DrzewoKwadrantowe::ListaOddzialywan lista;
+        for (std::size_t l = 0; l < drzewo.liczbaLisci(); ++l) drzewo.silyLiscia(l, theta, G, lista, silyX.data(), silyY.data());
+    }
+    int krok = std::max(1, n / maksProbek);
+    double sumaBledu = 0, sumaSily = 0;
+    for (int i = 0; i < n; i += krok) {
+        sf::Vector2f dokladna = silaBezposrednia(i, dyski, G);
+        sf::Vector2f przyblizona = liscmi ? sf::Vector2f(silyX[i], silyY[i]) : drzewo.sila(i, dyski, theta, G);
+        sf::Vector2f roznica = przyblizona - dokladna;
+        double bladKw = roznica.x * roznica.x + roznica.y * roznica.y;
+        double silaKw = dokladna.x * dokladna.x + dokladna.y * dokladna.y;
+        sumaBledu += bladKw;
+        sumaSily += silaKw;
+        if (silaKw > 0) blad.maksWzgledny = std::max(blad.maksWzgledny, static_cast<float>(std::sqrt(bladKw / silaKw)));
+        ++blad.probki;
+    }
+    if (sumaSily > 0) blad.wzglednyRMS = static_cast<float>(std::sqrt(sumaBledu / sumaSily));
+    return blad;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <algorithm>
+#include "../wspolne/magazyn_dyskow.hpp"
+
+// Hierarchiczne kroki blokowe (leapfrog kick-drift-kick z indywidualnym krokiem).
+// Krok globalny dt dzielony jest na 2^maksSzczebel tyknięć; dysk na szczeblu r porusza się
+// krokiem dt / 2^r, dobieranym z jego przyspieszenia: eta * sqrt(skala / |a|). Pozycje
+// wszystkich dysków przesuwane są do najbliższej chwili, w której kończy się czyjś krok,
+// a siły liczone są tylko dla dysków kończących krok (szczeble "aktywne"). Dysk może
+// zmniejszyć krok na końcu dowolnego swojego kroku, a zwiększyć - tylko w chwili
+// wyrównanej do dłuższego kroku, żeby szczeble pozostały zsynchronizowane.
+class KrokiBlokowe {
+public:
+    static const int MAKS_SZCZEBLI = 12;
+
+    int maksSzczebel = 6;
+    float eta = 0.2f;
+    float skala = 1.0f; // [px] - odległość, poniżej której silaPrzyciagania przestaje rosnąć
+
+    // Przyspieszenia i szczeble są nieaktualne - np. po wczytaniu migawki albo zmianie sił
+    void uniewaznij() { zsynchronizowane = false; }
+
+    // Przyspieszenia i szczeble idą za przestawionymi dyskami; między krokami wszystkie
+    // dyski są zsynchronizowane, więc kolejność nie ma innego znaczenia
+    void przestaw(const std::vector<std::uint32_t>& kolejnosc) {
+        if (szczebel.size() != kolejnosc.size()) return;
+        ::przestaw(ax, kolejnosc);
+        ::przestaw(ay, kolejnosc);
+        ::przestaw(szczebel, kolejnosc);
+    }
+
+    // Jeden krok globalny dt. obliczSily(indeksy, liczba, fx, fy) wypełnia fx[k], fy[k]
+    // siłą działającą na dysk indeksy[k] w bieżących pozycjach wszystkich dysków;
+    // bloki(n, zadanie) jak w Calkownik.
+    template <typename Sily, typename Bloki>
+    void krok(MagazynDyskow& dyski, float dt, float szerokosc, float wysokosc, Sily obliczSily, Bloki bloki) {
+        const std::size_t n = dyski.rozmiar();
+        const int k = std::max(0, std::min(maksSzczebel, MAKS_SZCZEBLI - 1));
+        const long tykniecia = 1L << k;
+        const float dtTykniecia = dt / tykniecia;
+
+        if (!zsynchronizowane || szczebel.size() != n || k != ostatnieK) {
+            ax.resize(n);
+            ay.resize(n);
+            szczebel.assign(n, 0);
+            aktywne.resize(n);
+            for (std::size_t i = 0; i < n; ++i) aktywne[i] = static_cast<int>(i);
+            przyspieszenia(dyski, n, obliczSily, bloki);
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                for (std::size_t i = od; i < doIndeksu; ++i) szczebel[i] = dobierzSzczebel(i, dt, k, 0, tykniecia);
+            });
+            zsynchronizowane = true;
+            ostatnieK = k;
+        }
+
+        std::fill(liczebnosc, liczebnosc + MAKS_SZCZEBLI, 0);
+        for (std::size_t i = 0; i < n; ++i) ++liczebnosc[szczebel[i]];
+        for (int r = 0; r <= k; ++r) sumaLiczebnosci[r] += liczebnosc[r];
+        int najwyzszy = 0;
+
+        for (long t = 0; t < tykniecia;) {
+            // Otwierający półkrok prędkości dysków zaczynających teraz krok
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                for (std::size_t i = od; i < doIndeksu; ++i) {
+                    long dlugosc = tykniecia >> szczebel[i];
+                    if (t % dlugosc != 0) continue;
+                    float polowa = 0.5f * dlugosc * dtTykniecia;
+                    dyski.vx[i] += ax[i] * polowa;
+                    dyski.vy[i] += ay[i] * polowa;
+                }
+            });
+
+            // Ruch wszystkich dysków do końca najkrótszego trwającego kroku
+            int rMax = 0;
+            for (int r = k; r > 0; --r) {
+                if (liczebnosc[r] > 0) { rMax = r; break; }
+            }
+            najwyzszy = std::max(najwyzszy, rMax);
+            const long przesuniecie = tykniecia >> rMax;
+            bloki(n, [&](std::size_t od, std::size_t doIndeksu) {
+                dyski.zaktualizujPozycje(przesuniecie * dtTykniecia, szerokosc, wysokosc, od, doIndeksu);
+            });
+            t += przesuniecie;
+
+            // Siły tylko dla dysków kończących krok, zamykający półkrok i nowy szczebel
+            std::size_t liczba = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (t % (tykniecia >> szczebel[i]) == 0) aktywne[liczba++] = static_cast<int>(i);
+            }
+            przyspieszenia(dyski, liczba, obliczSily, bloki);
+            bloki(liczba, [&](std::size_t od, std::size_t doIndeksu) {
+                for (std::size_t a = od; a < doIndeksu; ++a) {
+                    int i = aktywne[a];
+                    float polowa = 0.5f * (tykniecia >> szczebel[i]) * dtTykniecia;
+                    dyski.vx[i] += ax[i] * polowa;
+                    dyski.vy[i] += ay[i] * polowa;
+                    szczebel[i] = dobierzSzczebel(i, dt, k, t, tykniecia);
+                }
+            });
+            std::fill(liczebnosc, liczebnosc + MAKS_SZCZEBLI, 0);
+            for (std::size_t i = 0; i < n; ++i) ++liczebnosc[szczebel[i]];
+        }
+
+        ++kroki;
+        czasSymulacji += dt;
+        // Krok globalny o długości najkrótszego użytego kroku liczyłby siły wszystkich dysków w każdym tyknięciu
+        ewaluacjeGlobalne += static_cast<double>(n) * (1L << najwyzszy);
+    }
+
+    // Liczba dysków na szczeblach 0..maksSzczebel po ostatnim kroku
+    const int* liczebnosci() const { return liczebnosc; }
+
+    std::string opisLiczebnosci() const {
+        std::string opis;
+        for (int r = 0; r <= std::min(maksSzczebel, MAKS_SZCZEBLI - 1); ++r) {
+            if (r > 0) opis += " ";
+            opis += std::to_string(liczebnosc[r]);
+        }
+        return opis;
+    }
+
+    // Średnie liczebności szczebli na krok i koszt sił względem kroku globalnego
+    void wypisz() const {
+        if (kroki == 0) return;
+        std::printf("szczeble (dt / 2^r, średnio dysków na krok):");
+        for (int r = 0; r <= std::min(maksSzczebel, MAKS_SZCZEBLI - 1); ++r) {
+            std::printf(" %d: %.1f", r, static_cast<double>(sumaLiczebnosci[r]) / kroki);
+        }
+        std::printf("\n");
+        std::printf("ewaluacje sił dysków na sekundę symulacji = %.0f, przy kroku globalnym = %.0f (%.1fx więcej)\n",
+                    ewaluacje / czasSymulacji, ewaluacjeGlobalne / czasSymulacji,
+                    ewaluacje > 0 ? ewaluacjeGlobalne / ewaluacje : 0.0);
+    }
+
+private:
+    TablicaWyrownana ax, ay, fx, fy;
+    std::vector<unsigned char> szczebel;
+    std::vector<int> aktywne;
+    bool zsynchronizowane = false;
+    int ostatnieK = -1;
+
+    int liczebnosc[MAKS_SZCZEBLI] = {};
+    long long sumaLiczebnosci[MAKS_SZCZEBLI] = {};
+    long long kroki = 0;
+    double czasSymulacji = 0;
+    double ewaluacje = 0, ewaluacjeGlobalne = 0;
+
+    template <typename Sily, typename Bloki>
+    void przyspieszenia(const MagazynDyskow& dyski, std::size_t liczba, Sily& obliczSily, Bloki& bloki) {
+        if (liczba == 0) return;
+        fx.resize(liczba);
+        fy.resize(liczba);
+        obliczSily(aktywne.data(), liczba, fx.data(), fy.data());
+        ewaluacje += static_cast<double>(liczba);
+        bloki(liczba, [&](std::size_t od, std::size_t doIndeksu) {
+            for (std::size_t a = od; a < doIndeksu; ++a) {
+                int i = aktywne[a];
+                ax[i] = fx[a] / dyski.masa[i];
+                ay[i] = fy[a] / dyski.masa[i];
+            }
+        });
+    }
+
+    // Najmniejszy szczebel spełniający kryterium; w górę bez ograniczeń, w dół tylko do
+    // szczebla, którego krok zaczyna się w tyknięciu t
+    unsigned char dobierzSzczebel(std::size_t i, float dt, int k, long t, long tykniecia) const {
+        float a = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i]);
+        int r = 0;
+        if (a > 0) {
+            float krokDysku = eta * std::sqrt(skala / a);
+            while (r < k && dt / static_cast<float>(1L << r) > krokDysku) ++r;
+        }
+        int biezacy = szczebel[i];
+        while (r < biezacy && t % (tykniecia >> (biezacy - 1)) == 0) --biezacy;
+        return static_cast<unsigned char>(std::max(r, biezacy));
+    }
+};
@@ -4,6 +4,25 @@
 #include <random>
 #include <iostream>
 #include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "siatka.hpp"
+#include "zderzenia.hpp"
+#include "silnik_zdarzen.hpp"
+#include "../wspolne/magazyn_dyskow.hpp"
+#include "../wspolne/argumenty.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/tryb_wsadowy.hpp"
+#include "../wspolne/trajektoria.hpp"
+#include "../wspolne/profiler.hpp"
+#include "../wspolne/zasoby.hpp"
+#include "../wspolne/calkowanie.hpp"
+#include "../wspolne/porzadek_mortona.hpp"
+#include "../wspolne/liczniki_sprzetowe.hpp"
+#include "../wspolne/pole_przyciagania.hpp"
 
 const int szerokosc_okna = 800;
 const int wysokosc_okna = 600;
@@ -12,39 +31,10 @@ const float czas = 0.01f;
 const float G = 100.0f; // Stała przyciągania
 const sf::Vector2f SRODEK(szerokosc_okna / 2.0f, wysokosc_okna / 2.0f);
 
-// Struktura Dysku
-struct Dysk {
-    sf::CircleShape ksztalt;
-    sf::Vector2f v;
-    float masa;
-    float wsp_oporu;
-
-    Dysk(float x, float y, float vx, float vy, float m, float srednica, sf::Color kolor)
-        : v(vx, vy), masa(m) {
-        ksztalt.setRadius(srednica / 2.0f);
-        ksztalt.setFillColor(kolor);
-        ksztalt.setPosition(x, y);
-        wsp_oporu = 0.01f + (std::sin(x / 100.0f) + 1.0f) * 0.05f; // Opór zależny od pozycji
-    }
-
-    void zastosujSile(const sf::Vector2f& F) {
-        v += F * (czas / masa);
-    }
-
-    void zaktualizujPozycje() {
-        sf::Vector2f opor = -wsp_oporu * v;  // Opór proporcjonalny do prędkości
-        zastosujSile(opor);
-        ksztalt.move(v * czas);
-
-        // Odbicia od krawędzi
-        sf::Vector2f pozycja = ksztalt.getPosition();
-        if (pozycja.x < 0) { pozycja.x = 0; v.x *= -1; }
-        else if (pozycja.x > szerokosc_okna - 2 * ksztalt.getRadius()) { pozycja.x = szerokosc_okna - 2 * ksztalt.getRadius(); v.x *= -1; }
-        if (pozycja.y < 0) { pozycja.y = 0; v.y *= -1; }
-        else if (pozycja.y > wysokosc_okna - 2 * ksztalt.getRadius()) { pozycja.y = wysokosc_okna - 2 * ksztalt.getRadius(); v.y *= -1; }
-        ksztalt.setPosition(pozycja);
-    }
-};
+// Opór zależny od położenia początkowego dysku
+float wspolczynnikOporu(float x) {
+    return 0.01f + (std::sin(x / 100.0f) + 1.0f) * 0.05f; // Opór zależny od pozycji
+}
 
 // Siła przyciągająca do centrum lub innych punktów
 sf::Vector2f silaPrzyciagania(const sf::Vector2f& pozycja, const sf::Vector2f& punkt, float intensywnosc) {
@@ -55,99 +45,390 @@ sf::Vector2f silaPrzyciagania(const sf::Vector2f& pozycja, const sf::Vector2f& p
     return kierunek * (intensywnosc / (odleglosc * odleglosc));
 }
 
-// Zderzenia sprężyste
-void zderzeniaSprężyste(Dysk& d1, Dysk& d2) {
-    sf::Vector2f delta = d1.ksztalt.getPosition() - d2.ksztalt.getPosition();
-    float odleglosc = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-    float promienSum = d1.ksztalt.getRadius() + d2.ksztalt.getRadius();
+// Siła jednego punktu przyciągania - dokładna, do sumy i do wypiekania pola
+const auto silaPunktu = [](const sf::Vector2f& pozycja, const sf::Vector2f& punkt) {
+    return silaPrzyciagania(pozycja, punkt, G);
+};
+
+// Generowanie liczb losowych; bez --seed w oknie ziarno pochodzi z std::random_device
+GeneratorLosowy gen(std::random_device{}());
+const float min_srednica = 10.0f;
+const float maks_srednica = 40.0f;
+
+sf::Color losujKolor() {
+    return sf::Color(gen.calkowita(256), gen.calkowita(256), gen.calkowita(256));
+}
+
+// Stan symulacji wraz z jednym krokiem - wspólny dla trybu okienkowego i wsadowego
+struct Symulacja {
+    MagazynDyskow dyski;
+    std::vector<sf::Vector2f> punktyPrzyciagania{SRODEK};
+    // Przy wielu punktach ich siła z siatki zamiast sumy po punktach
+    PolePrzyciagania pole;
+    Calkownik calkownik;
 
-    if (odleglosc < promienSum) {
-        sf::Vector2f normal = delta / odleglosc;
-        sf::Vector2f relV = d1.v - d2.v;
-        float prędkośćWzdłużNormalnej = relV.x * normal.x + relV.y * normal.y;
+    // Faza szeroka zderzeń
+    SiatkaPrzestrzenna siatka;
+    float maksSrednica = maks_srednica;
+    long long paryKandydujace = 0, kontakty = 0;
 
-        if (prędkośćWzdłużNormalnej < 0) {
-            float odbicie = 2.0f * prędkośćWzdłużNormalnej / (d1.masa + d2.masa);
-            d1.v -= odbicie * d2.masa * normal;
-            d2.v += odbicie * d1.masa * normal;
+    // Zderzenia sterowane zdarzeniami zamiast wykrywania nałożeń po kroku (--events)
+    SilnikZdarzen silnik;
+    bool zdarzeniowy = false;
+    TablicaWyrownana silyX, silyY;
+
+    // Dyski porządkowane wzdłuż krzywej Mortona co porzadek.co kroków (--reorder)
+    PorzadekMortona porzadek;
+    std::uint64_t wykonaneKroki = 0;
+
+    void utworzDyski(int liczbaDyskow) {
+        for (int i = 0; i < liczbaDyskow; ++i) {
+            float x = gen.przedzial(0, szerokosc_okna - 50);
+            float y = gen.przedzial(0, wysokosc_okna - 50);
+            float vx = gen.przedzial(-50, 50);
+            float vy = gen.przedzial(-50, 50);
+            float masa = gen.przedzial(1.0f, 5.0f);
+            float srednica = gen.przedzial(min_srednica, maks_srednica);
+            sf::Color kolor = losujKolor();
+            dyski.dodaj(x, y, vx, vy, masa, srednica, wspolczynnikOporu(x), kolor);
         }
     }
-}
 
-// Generowanie liczb losowych
-std::random_device rd;
-std::mt19937 gen(rd());
-std::uniform_real_distribution<> dis(-50, 50);
-std::uniform_real_distribution<> posX(0, szerokosc_okna - 50);
-std::uniform_real_distribution<> posY(0, wysokosc_okna - 50);
-std::uniform_real_distribution<> rozkladMas(1.0, 5.0);
-std::uniform_real_distribution<> rozkladSrednicy(10.0, 40.0);
-std::uniform_int_distribution<> kolor(0, 255);
+    // Dodatkowe punkty przyciągania w losowych miejscach okna (--points)
+    void dodajLosowePunkty(int liczba) {
+        for (int i = 0; i < liczba; ++i) {
+            float x = gen.przedzial(0, szerokosc_okna);
+            float y = gen.przedzial(0, wysokosc_okna);
+            punktyPrzyciagania.emplace_back(x, y);
+        }
+    }
 
-sf::Color losujKolor() {
-    return sf::Color(kolor(gen), kolor(gen), kolor(gen));
-}
+    void krok() {
+        if (porzadek.pora(wykonaneKroki++)) uporzadkuj();
+        {
+            // Punkty dodane od poprzedniego kroku trafiają do siatki
+            Strefa strefa("pole");
+            pole.zaktualizuj(punktyPrzyciagania, szerokosc_okna, wysokosc_okna, silaPunktu);
+        }
+        if (zdarzeniowy) {
+            krokZdarzeniowy();
+            return;
+        }
 
-int main() {
-    sf::RenderWindow okno(sf::VideoMode(szerokosc_okna, wysokosc_okna), "Rozszerzona Symulacja Dysków");
-    std::vector<Dysk> dyski;
-    std::vector<sf::Vector2f> punktyPrzyciagania{SRODEK};
+        // Zderzenia między dyskami - faza wąska tylko dla par z sąsiednich komórek siatki
+        Strefa strefaZderzen("zderzenia");
+        siatka.zbuduj(dyski.x.data(), dyski.y.data(), static_cast<int>(dyski.rozmiar()), maksSrednica);
+        paryKandydujace = kontakty = 0;
+        siatka.dlaParKandydujacych([&](int i, int j) {
+            ++paryKandydujace;
+            if (zderzeniaSprężyste(dyski, i, j)) ++kontakty;
+        });
+        strefaZderzen.zakoncz();
 
-    // Tworzenie początkowych dysków
-    for (int i = 0; i < ilosc_dyskow; ++i) {
-        float x = posX(gen);
-        float y = posY(gen);
-        float vx = dis(gen);
-        float vy = dis(gen);
-        float masa = rozkladMas(gen);
-        float srednica = rozkladSrednicy(gen);
-        sf::Color kolor = losujKolor();
-        dyski.emplace_back(x, y, vx, vy, masa, srednica, kolor);
+        // Aktualizacja pozycji dysków i sił; zderzenia zmieniły tylko prędkości,
+        // więc siły zapamiętane przez leapfrog pozostają aktualne
+        Strefa strefaRuchu("ruch");
+        calkownik.krok(
+            dyski, szerokosc_okna, wysokosc_okna,
+            [&](const MagazynDyskow& stan, float* silyX, float* silyY) { obliczSily(stan, silyX, silyY); },
+            [](std::size_t n, const auto& zadanie) { zadanie(0, n); });
     }
 
-    while (okno.isOpen()) {
-        sf::Event event;
-        while (okno.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) okno.close();
-
-            // Dodawanie punktów przyciągania
-            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                sf::Vector2f nowyPunkt(event.mouseButton.x, event.mouseButton.y);
-                punktyPrzyciagania.push_back(nowyPunkt);
+    // Siły i opór jako impuls prędkości na początku kroku, potem lot bez sił z dokładnymi
+    // zderzeniami. Bez punktów przyciągania i oporu prędkości zmieniają tylko zdarzenia,
+    // więc przewidziane zdarzenia przechodzą do następnego kroku bez przebudowy kolejki.
+    void krokZdarzeniowy() {
+        const float dt = calkownik.dt;
+        Strefa strefaRuchu("ruch");
+        bool opor = std::any_of(dyski.wsp_oporu.begin(), dyski.wsp_oporu.end(), [](float k) { return k != 0; });
+        if (!punktyPrzyciagania.empty() || opor) {
+            silyX.resize(dyski.rozmiar());
+            silyY.resize(dyski.rozmiar());
+            obliczSily(dyski, silyX.data(), silyY.data());
+            dyski.zastosujSily(silyX.data(), silyY.data(), dt);
+            for (std::size_t i = 0; i < dyski.rozmiar(); ++i) {
+                float s = dt / dyski.masa[i];
+                dyski.vx[i] += -dyski.wsp_oporu[i] * dyski.vx[i] * s;
+                dyski.vy[i] += -dyski.wsp_oporu[i] * dyski.vy[i] * s;
             }
+            silnik.uniewaznij();
         }
+        strefaRuchu.zakoncz();
 
-        // Aktualizacja pozycji dysków i sił
-        for (size_t i = 0; i < dyski.size(); ++i) {
-            sf::Vector2f silaCalkowita(0, 0);
+        Strefa strefaZderzen("zderzenia");
+        long long przed = silnik.liczbaZderzen();
+        silnik.przesun(dyski, dt, szerokosc_okna, wysokosc_okna, maksSrednica);
+        kontakty = silnik.liczbaZderzen() - przed;
+        paryKandydujace = 0;
+    }
 
+    // Dyski bliskie w przestrzeni obok siebie w pamięci - siatka zderzeń czyta wtedy sąsiednie
+    // komórki prawie sekwencyjnie. Siły leapfrogu idą za dyskami, a kolejka zdarzeń trzyma
+    // indeksy, więc jest przewidywana od nowa.
+    void uporzadkuj() {
+        Strefa strefa("porzadek");
+        const std::vector<std::uint32_t>& kolejnosc = porzadek.uporzadkuj(dyski.x.data(), dyski.y.data(), dyski.rozmiar());
+        dyski.przestaw(kolejnosc);
+        calkownik.przestaw(kolejnosc);
+        silnik.uniewaznij();
+    }
+
+    void obliczSily(const MagazynDyskow& stan, float* silyX, float* silyY) const {
+        for (size_t i = 0; i < stan.rozmiar(); ++i) {
             // Przyciąganie do każdego punktu
-            for (const auto& punkt : punktyPrzyciagania) {
-                silaCalkowita += silaPrzyciagania(dyski[i].ksztalt.getPosition(), punkt, G);
+            sf::Vector2f silaCalkowita = pole.sila(stan.pozycja(i), punktyPrzyciagania, silaPunktu);
+
+            silyX[i] = silaCalkowita.x;
+            silyY[i] = silaCalkowita.y;
+        }
+    }
+
+    // Energia i pęd do pomiaru dryfu metody całkowania; zderzenia sprężyste zachowują oba
+    BilansEnergii bilans() const {
+        BilansEnergii wynik = bilansRuchu(dyski);
+        for (std::size_t i = 0; i < dyski.rozmiar(); ++i) {
+            for (const auto& punkt : punktyPrzyciagania) wynik.potencjalna += potencjalPrzyciagania(dyski.pozycja(i), punkt, G);
+        }
+        return wynik;
+    }
+
+    // Dyski i punkty przyciągania w jednej partii renderera
+    void rysuj(sf::RenderTarget& cel, RendererKol& renderer) const {
+        cel.clear();
+        dyski.wypelnijRenderer(renderer);
+        for (const auto& punkt : punktyPrzyciagania) {
+            renderer.dodaj(punkt.x, punkt.y, 5, sf::Color::Red);
+        }
+        renderer.rysuj(cel);
+    }
+
+    // Migawka: dyski i punkty przyciągania; błędy są wypisywane na stderr
+    bool zapisz(const std::string& sciezka, bool kompresja) const {
+        ZapisMigawki zapis("zadanie_4");
+        dyski.zapisz(zapis);
+        zapis.blok("punkty", punktyPrzyciagania.data(), punktyPrzyciagania.size());
+        // Faza porządkowania i identyfikatory - wznowiony przebieg porządkuje w tych samych krokach
+        zapis.wartosc("kroki", wykonaneKroki);
+        zapis.blok("identyfikatory", porzadek.identyfikatory().data(), porzadek.identyfikatory().size());
+        if (zapis.zapisz(sciezka, kompresja)) return true;
+        std::fprintf(stderr, "%s: nie udało się zapisać migawki\n", sciezka.c_str());
+        return false;
+    }
+
+    bool wczytaj(const std::string& sciezka) {
+        OdczytMigawki odczyt;
+        if (!odczyt.otworz(sciezka)) {
+            std::fprintf(stderr, "%s: %s\n", sciezka.c_str(), odczyt.komunikat().c_str());
+            return false;
+        }
+        if (!dyski.wczytaj(odczyt)) {
+            std::fprintf(stderr, "%s: migawka nie zawiera kompletnych dysków\n", sciezka.c_str());
+            return false;
+        }
+        // Punkty są opcjonalne - migawka z innego programu może ich nie mieć
+        if (!odczyt.wczytaj("punkty", punktyPrzyciagania)) punktyPrzyciagania.assign(1, SRODEK);
+        // Komórki siatki zderzeń muszą pomieścić największy wczytany dysk
+        maksSrednica = maks_srednica;
+        for (float r : dyski.promien) maksSrednica = std::max(maksSrednica, 2 * r);
+        calkownik.uniewaznij();
+        silnik.uniewaznij();
+        // Bez kroków i identyfikatorów (starsza migawka) porządkowanie zaczyna się od nowa
+        std::vector<std::uint32_t> identyfikatory;
+        if (!odczyt.wczytaj("identyfikatory", identyfikatory) || identyfikatory.size() != dyski.rozmiar()) {
+            identyfikatory.clear();
+        }
+        porzadek.zresetuj(std::move(identyfikatory));
+        if (!odczyt.wartosc("kroki", wykonaneKroki)) wykonaneKroki = 0;
+        return true;
+    }
+
+    std::uint64_t sumaKontrolna() const {
+        SumaKontrolna suma;
+        suma.dodaj(dyski.x.data(), dyski.rozmiar());
+        suma.dodaj(dyski.y.data(), dyski.rozmiar());
+        suma.dodaj(dyski.vx.data(), dyski.rozmiar());
+        suma.dodaj(dyski.vy.data(), dyski.rozmiar());
+        return suma.wartosc();
+    }
+};
+
+// Uruchomienie: disk_simulation [--disks N | --load PLIK] [--save PLIK [--compress]] [--seed S]
+//                                [--headless KROKI [--render KLATKI]]
+//                                [--trajectory PLIK [--every N] [--fields x,y,vx,vy] [--csv PLIK]]
+//                                [--profile] [--trace PLIK]
+//                                [--integrator euler|leapfrog|rk4] [--dt KROK] [--no-drag] [--energy]
+//                                [--events] [--no-attraction] [--reorder KROKI] [--cache-misses]
+//                                [--points N] [--field-tolerance TOL] [--field-cell PX] [--exact-attraction]
+int main(int argc, char* argv[]) {
+    Argumenty argumenty(argc, argv);
+    wlaczProfiler(argumenty);
+    // Bez --seed okno losuje ziarno, a tryb wsadowy bierze 1 - jak zadanie_5 i zadanie_6
+    if (argumenty.jest("seed") || argumenty.jest("headless")) {
+        gen.seed(static_cast<std::uint64_t>(argumenty.liczbaCalkowita("seed", 1)));
+    }
+    LicznikiSprzetowe liczniki;
+    wlaczLiczniki(liczniki, argumenty);
+
+    Symulacja sym;
+    if (!ustawCalkownik(sym.calkownik, argumenty, czas)) return 1;
+    // --load: stan z migawki zamiast losowych dysków; --save: zapis po przebiegu wsadowym
+    // albo klawiszem F5 w oknie (F9 wczytuje ponownie)
+    const std::string plikZapisu = argumenty.tekst("save", "zadanie_4.migawka");
+    const std::string plikOdczytu = argumenty.tekst("load", plikZapisu);
+    const bool kompresja = argumenty.jest("compress");
+    if (argumenty.jest("load")) {
+        if (!sym.wczytaj(plikOdczytu)) return 1;
+    } else {
+        sym.utworzDyski(static_cast<int>(argumenty.liczbaCalkowita("disks", ilosc_dyskow)));
+    }
+    // --no-drag: bez oporu energia powinna być zachowana - do porównania dryfu metod
+    if (argumenty.jest("no-drag")) sym.dyski.wsp_oporu.assign(sym.dyski.rozmiar(), 0.0f);
+    // --events: dokładne czasy zderzeń zamiast kroku stałego; z --no-attraction i --no-drag
+    // dyski są czysto twarde i energia kinetyczna jest zachowana
+    sym.zdarzeniowy = argumenty.jest("events");
+    if (argumenty.jest("no-attraction")) sym.punktyPrzyciagania.clear();
+    sym.porzadek.co = static_cast<int>(argumenty.liczbaCalkowita("reorder", 0));
+    sym.dodajLosowePunkty(static_cast<int>(argumenty.liczbaCalkowita("points", 0)));
+    // Pole przyciągania: dopuszczalny błąd siły punktu względem sumy dokładnej i bok komórki
+    if (!ustawPole(sym.pole, argumenty)) return 1;
+
+    // Trajektoria: stan początkowy jako krok 0, potem stan po każdym kroku. Dyski zapisywane są
+    // w kolejności identyfikatorów, więc porządkowanie nie zmienia numerów ciał w pliku.
+    ZapisTrajektorii trajektoria;
+    if (!otworzTrajektorie(trajektoria, argumenty, sym.calkownik.dt)) return 1;
+    std::uint64_t krokSymulacji = 0;
+    std::vector<float> kolumny[4];
+    auto zapiszKrok = [&] {
+        if (!trajektoria.zapisze(krokSymulacji)) return;
+        const MagazynDyskow& d = sym.dyski;
+        const std::size_t n = d.rozmiar();
+        trajektoria.krok(krokSymulacji, n, sym.porzadek.wedlugIdentyfikatorow(d.x.data(), n, kolumny[0]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.y.data(), n, kolumny[1]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.vx.data(), n, kolumny[2]),
+                         sym.porzadek.wedlugIdentyfikatorow(d.vy.data(), n, kolumny[3]));
+    };
+    zapiszKrok();
+
+    // Tryb wsadowy: stała liczba kroków bez otwierania okna
+    if (argumenty.jest("headless")) {
+        long long kroki = argumenty.liczbaCalkowita("headless", 1000);
+        long long sumaKandydatow = 0, sumaKontaktow = 0;
+        const bool bilans = argumenty.jest("energy");
+        BilansEnergii poczatek;
+        if (bilans) poczatek = sym.bilans();
+        PomiarWsadowy pomiar;
+        pomiar.start();
+        liczniki.start();
+        for (long long k = 0; k < kroki; ++k) {
+            profiler().poczatekKlatki();
+            sym.krok();
+            ++krokSymulacji;
+            zapiszKrok();
+            profiler().koniecKlatki();
+            sumaKandydatow += sym.paryKandydujace;
+            sumaKontaktow += sym.kontakty;
+            pomiar.krok(sym.dyski.rozmiar());
+        }
+        liczniki.stop();
+        pomiar.stop();
+        if (sym.zdarzeniowy) {
+            std::printf("dyski = %zu, zderzenia/krok = %.1f, dt = %g\n", sym.dyski.rozmiar(),
+                        kroki > 0 ? static_cast<double>(sumaKontaktow) / kroki : 0.0, sym.calkownik.dt);
+            sym.silnik.wypisz(pomiar.sekundy());
+        } else {
+            std::printf("dyski = %zu, pary kandydujące/krok = %.1f, kontakty/krok = %.1f\n", sym.dyski.rozmiar(),
+                        kroki > 0 ? static_cast<double>(sumaKandydatow) / kroki : 0.0,
+                        kroki > 0 ? static_cast<double>(sumaKontaktow) / kroki : 0.0);
+            wypiszKosztCalkowania(sym.calkownik, kroki);
+        }
+        if (bilans) wypiszDryf(poczatek, sym.bilans());
+        if (sym.porzadek.co > 0) {
+            std::printf("porządek Mortona: co %d kroków, porządkowania = %lld\n", sym.porzadek.co,
+                        sym.porzadek.liczbaPorzadkowan());
+        }
+        if (argumenty.jest("cache-misses")) liczniki.wypisz(static_cast<double>(pomiar.liczbaKrokowCial()));
+        if (sym.pole.uzywane()) {
+            sym.pole.wypisz(sym.pole.zmierzBlad(sym.dyski.x.data(), sym.dyski.y.data(), sym.dyski.rozmiar(),
+                                                sym.punktyPrzyciagania, silaPunktu),
+                            sym.punktyPrzyciagania.size());
+        }
+        pomiar.wypisz("zadanie_4", sym.sumaKontrolna());
+        // Krok przerwany po limicie zdarzeń to błąd silnika - przebieg kończy się kodem 1
+        if (sym.silnik.liczbaPrzerwanych() > 0) return 1;
+        if (!zakonczTrajektorie(trajektoria, argumenty) || !zakonczProfiler(argumenty)) return 1;
+        if (argumenty.jest("save") && !sym.zapisz(plikZapisu, kompresja)) return 1;
+
+        // --render N: dodatkowo N klatek rysowanych do tekstury poza ekranem
+        if (argumenty.jest("render")) {
+            RendererKol renderer;
+            PomiarRenderowania pomiarRenderowania;
+            if (!pomiarRenderowania.utworz(szerokosc_okna, wysokosc_okna)) return 1;
+            long long klatki = argumenty.liczbaCalkowita("render", 100);
+            for (long long k = 0; k < klatki; ++k) {
+                pomiarRenderowania.klatka([&](sf::RenderTarget& cel) { sym.rysuj(cel, renderer); });
             }
+            pomiarRenderowania.wypisz(renderer.wywolania());
+        }
+        return 0;
+    }
+
+    sf::RenderWindow okno(sf::VideoMode(szerokosc_okna, wysokosc_okna), "Rozszerzona Symulacja Dysków");
+    RendererKol renderer;
+    Zasoby zasoby(argv[0]);
+    NakladkaProfilera nakladka(zasoby.czcionka("arial.ttf"));
+    nakladka.widoczna = profiler().wlaczony();
+    int klatka = 0;
+
+    while (okno.isOpen()) {
+        profiler().poczatekKlatki();
+        {
+            Strefa strefa("zdarzenia");
+            sf::Event event;
+            while (okno.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) okno.close();
+
+                // Dodawanie punktów przyciągania
+                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                    sf::Vector2f nowyPunkt(event.mouseButton.x, event.mouseButton.y);
+                    sym.punktyPrzyciagania.push_back(nowyPunkt);
+                    sym.calkownik.uniewaznij();
+                }
 
-            // Zderzenia między dyskami
-            for (size_t j = i + 1; j < dyski.size(); ++j) {
-                zderzeniaSprężyste(dyski[i], dyski[j]);
+                // F5 / F9 - zapis / odczyt migawki, F3 - nakładka profilera, I - zmiana metody całkowania
+                if (event.type == sf::Event::KeyPressed) {
+                    if (event.key.code == sf::Keyboard::F5) sym.zapisz(plikZapisu, kompresja);
+                    else if (event.key.code == sf::Keyboard::F9) sym.wczytaj(plikOdczytu);
+                    else if (event.key.code == sf::Keyboard::F3) {
+                        profiler().wlacz(true);
+                        nakladka.widoczna = !nakladka.widoczna;
+                    } else if (event.key.code == sf::Keyboard::I) {
+                        sym.calkownik.metoda = nastepnaMetoda(sym.calkownik.metoda);
+                        sym.calkownik.uniewaznij();
+                    }
+                }
             }
+        }
 
-            dyski[i].zastosujSile(silaCalkowita);
-            dyski[i].zaktualizujPozycje();
+        sym.krok();
+        ++krokSymulacji;
+        zapiszKrok();
+        if (++klatka % 30 == 0) {
+            okno.setTitle("Rozszerzona Symulacja Dysków | pary kandydujące: " + std::to_string(sym.paryKandydujace) +
+                          ", kontakty: " + std::to_string(sym.kontakty) + ", " + nazwaMetody(sym.calkownik.metoda));
         }
 
-        // Rysowanie
-        okno.clear();
-        for (const auto& dysk : dyski) {
-            okno.draw(dysk.ksztalt);
+        {
+            Strefa strefa("rysowanie");
+            sym.rysuj(okno, renderer);
+            nakladka.rysuj(okno, sym.dyski.rozmiar(), renderer.wywolania());
         }
-        for (const auto& punkt : punktyPrzyciagania) {
-            sf::CircleShape punktShape(5);
-            punktShape.setFillColor(sf::Color::Red);
-            punktShape.setPosition(punkt);
-            okno.draw(punktShape);
+        {
+            Strefa strefa("display");
+            okno.display();
         }
-        okno.display();
+        profiler().koniecKlatki();
     }
 
-    return 0;
+    bool ok = zakonczTrajektorie(trajektoria, argumenty);
+    return zakonczProfiler(argumenty) && ok ? 0 : 1;
 }
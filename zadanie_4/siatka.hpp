@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Jednorodna siatka (faza szeroka): dyski sortowane kubełkowo do komórek,
+// pary kandydujące szukane tylko w tej samej i sąsiednich komórkach
+class SiatkaPrzestrzenna {
+public:
+    // Maksymalna liczba komórek w jednym wymiarze - przy odległych dyskach komórki są powiększane
+    static const int MAKS_KOMOREK = 4096;
+
+    // rozmiarKomorki powinien być nie mniejszy niż największa średnica dysku
+    void zbuduj(const float* x, const float* y, int n, float rozmiarKomorki) {
+        komorkaDysku.resize(n);
+        dyskiPosortowane.resize(n);
+        if (n == 0) {
+            poczatekKomorki.assign(1, 0);
+            kolumny = wiersze = 0;
+            return;
+        }
+
+        minX = maxX = x[0];
+        minY = maxY = y[0];
+        for (int i = 0; i < n; ++i) {
+            minX = std::min(minX, x[i]); maxX = std::max(maxX, x[i]);
+            minY = std::min(minY, y[i]); maxY = std::max(maxY, y[i]);
+        }
+        rozmiar = std::max({rozmiarKomorki, (maxX - minX) / MAKS_KOMOREK, (maxY - minY) / MAKS_KOMOREK, 1e-3f});
+        kolumny = static_cast<int>((maxX - minX) / rozmiar) + 1;
+        wiersze = static_cast<int>((maxY - minY) / rozmiar) + 1;
+
+        // Sortowanie przez zliczanie: najpierw liczności komórek, potem sumy prefiksowe
+        poczatekKomorki.assign(static_cast<size_t>(kolumny) * wiersze + 1, 0);
+        for (int i = 0; i < n; ++i) {
+            komorkaDysku[i] = indeksKomorki(x[i], y[i]);
+            ++poczatekKomorki[komorkaDysku[i] + 1];
+        }
+        for (size_t c = 1; c < poczatekKomorki.size(); ++c) {
+            poczatekKomorki[c] += poczatekKomorki[c - 1];
+        }
+        wolne.assign(poczatekKomorki.begin(), poczatekKomorki.end() - 1);
+        for (int i = 0; i < n; ++i) {
+            dyskiPosortowane[wolne[komorkaDysku[i]]++] = i;
+        }
+    }
+
+    // Wywołuje f(i, j) dla każdej pary dysków z tej samej lub sąsiedniej komórki (każda para raz)
+    template <typename F>
+    void dlaParKandydujacych(F&& f) const {
+        // Połowa sąsiedztwa: bieżąca komórka oraz prawa, lewa-dolna, dolna i prawa-dolna
+        static const int dx[4] = {1, -1, 0, 1};
+        static const int dy[4] = {0, 1, 1, 1};
+        for (int wy = 0; wy < wiersze; ++wy) {
+            for (int kx = 0; kx < kolumny; ++kx) {
+                int c = wy * kolumny + kx;
+                for (int a = poczatekKomorki[c]; a < poczatekKomorki[c + 1]; ++a) {
+                    for (int b = a + 1; b < poczatekKomorki[c + 1]; ++b) {
+                        f(dyskiPosortowane[a], dyskiPosortowane[b]);
+                    }
+                }
+                for (int k = 0; k < 4; ++k) {
+                    int sx = kx + dx[k], sy = wy + dy[k];
+                    if (sx < 0 || sx >= kolumny || sy >= wiersze) continue;
+                    int s = sy * kolumny + sx;
+                    for (int a = poczatekKomorki[c]; a < poczatekKomorki[c + 1]; ++a) {
+                        for (int b = poczatekKomorki[s]; b < poczatekKomorki[s + 1]; ++b) {
+                            f(dyskiPosortowane[a], dyskiPosortowane[b]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    float minX = 0, maxX = 0, minY = 0, maxY = 0;
+    float rozmiar = 1;
+    int kolumny = 0, wiersze = 0;
+    std::vector<int> komorkaDysku;
+    std::vector<int> poczatekKomorki;
+    std::vector<int> wolne;
+    std::vector<int> dyskiPosortowane;
+
+    int indeksKomorki(float x, float y) const {
+        int kx = std::min(kolumny - 1, static_cast<int>((x - minX) / rozmiar));
+        int wy = std::min(wiersze - 1, static_cast<int>((y - minY) / rozmiar));
+        return wy * kolumny + kx;
+    }
+};
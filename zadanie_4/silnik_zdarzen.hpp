@@ -0,0 +1,281 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cassert>
+#include "../wspolne/magazyn_dyskow.hpp"
+
+// Zderzenia sterowane zdarzeniami: między zdarzeniami dyski lecą po prostych, a czasy
+// zderzeń dysk-dysk, odbić od krawędzi i przejść między komórkami siatki wyliczane są
+// dokładnie i trzymane w kolejce priorytetowej. Zdarzenie nie jest usuwane z kolejki,
+// gdy przestaje być aktualne - każdy dysk ma licznik zdarzeń, a zdarzenie zapamiętuje
+// liczniki z chwili przewidzenia i jest pomijane, jeśli któryś się zmienił.
+// Każdy dysk ma własny czas ostatniej aktualizacji, więc zdarzenie przesuwa tylko swoje
+// dyski. Komórki mają bok nie mniejszy niż największa średnica, więc partnerzy zderzenia
+// są zawsze w sąsiednich komórkach; przejście do nowej komórki to też zdarzenie.
+// Pozycje w dyskach to lewe górne rogi, jak w MagazynDyskow; zderzenia liczone są dla środków.
+// Dyski stykające się z dokładnością zaokrągleń zderzają się od razu, jeśli się zbliżają; para,
+// która właśnie się zderzyła, nie dostaje jednak ponownie zdarzenia w chwili 0. Pary nachodzące
+// głębiej (wylosowane jedna na drugiej) nie mają zdarzeń, dopóki się nie rozejdą - zderzanie
+// ich w chwili 0 wpędzało gęste upakowania w nieskończony ciąg zderzeń.
+class SilnikZdarzen {
+public:
+    // Prędkości lub pozycje zmienione poza silnikiem (siły, wczytanie migawki) - przy następnym
+    // przesun() wszystkie zdarzenia przewidywane są od nowa
+    void uniewaznij() { aktualny = false; }
+
+    // Ruch bez sił przez czas dt z dokładnymi zderzeniami sprężystymi i odbiciami od krawędzi
+    // [0, szerokosc] x [0, wysokosc]; po powrocie wszystkie dyski są w chwili końca kroku
+    void przesun(MagazynDyskow& d, double dt, float szerokosc, float wysokosc, float maksSrednica) {
+        const std::size_t n = d.rozmiar();
+        if (!aktualny || czasDysku.size() != n || szerokosc != w || wysokosc != h || maksSrednica > bok ||
+            kolejka.size() > 16 * n + 1024) {
+            przygotuj(d, szerokosc, wysokosc, maksSrednica);
+        }
+
+        const double koniec = teraz + dt;
+        // Zabezpieczenie przed zdarzeniami bez końca - nie powinno zadziałać, a gdy zadziała,
+        // liczbaPrzerwanych() > 0 oznacza błąd silnika: reszta kroku idzie wtedy bez zderzeń
+        const long long limit = 64 * static_cast<long long>(n) + 1024;
+        long long obsluzone = 0;
+        while (!kolejka.empty() && kolejka.top().czas <= koniec) {
+            if (++obsluzone > limit) {
+                assert(!"SilnikZdarzen: limit zdarzeń w jednym kroku");
+                ++przerwane;
+                aktualny = false;
+                break;
+            }
+            Zdarzenie z = kolejka.top();
+            kolejka.pop();
+            if (licznik[z.i] != z.licznikI || (z.j >= 0 && licznik[z.j] != z.licznikJ)) {
+                ++nieaktualne;
+                continue;
+            }
+            teraz = std::max(teraz, z.czas);
+            dogon(d, z.i);
+            if (z.j >= 0) {
+                dogon(d, z.j);
+                zderz(d, z.i, z.j);
+                ostatniPartner[z.i] = z.j;
+                ostatniPartner[z.j] = z.i;
+                ++licznik[z.i];
+                ++licznik[z.j];
+                przewidz(d, z.i);
+                przewidz(d, z.j);
+                ++zderzenia;
+            } else if (z.j == SCIANA_X || z.j == SCIANA_Y) {
+                odbij(d, z.i, z.j == SCIANA_X);
+                ostatniPartner[z.i] = -1;
+                ++licznik[z.i];
+                przewidz(d, z.i);
+                ++odbicia;
+            } else {
+                przenies(d, z.i, z.j == KOMORKA_X);
+                ++licznik[z.i];
+                przewidz(d, z.i);
+                ++przejscia;
+            }
+        }
+
+        teraz = koniec;
+        for (std::size_t i = 0; i < n; ++i) dogon(d, static_cast<int>(i));
+    }
+
+    long long liczbaZderzen() const { return zderzenia; }
+    long long liczbaOdbic() const { return odbicia; }
+    long long liczbaPrzerwanych() const { return przerwane; }
+
+    // Zdarzenia obsłużone (bez pominiętych nieaktualnych)
+    long long liczbaZdarzen() const { return zderzenia + odbicia + przejscia; }
+
+    void wypisz(double sekundy) const {
+        std::printf("zdarzenia: zderzenia = %lld, odbicia = %lld, przejścia komórek = %lld, nieaktualne = %lld, "
+                    "przebudowy = %lld, zdarzenia/s = %.0f\n",
+                    zderzenia, odbicia, przejscia, nieaktualne, przebudowy,
+                    sekundy > 0 ? liczbaZdarzen() / sekundy : 0.0);
+        if (przerwane > 0) std::printf("BŁĄD: kroki przerwane po limicie zdarzeń = %lld\n", przerwane);
+    }
+
+private:
+    // Rodzaj zdarzenia w polu j, gdy nie jest to zderzenie z dyskiem j
+    static const int SCIANA_X = -1, SCIANA_Y = -2, KOMORKA_X = -3, KOMORKA_Y = -4;
+    // Względne nałożenie (1 - odległość² / sigma²), do którego dyski uznawane są za stykające się
+    static constexpr double NALOZENIE = 1e-3;
+
+    struct Zdarzenie {
+        double czas;
+        int i, j;
+        unsigned licznikI, licznikJ;
+
+        bool operator>(const Zdarzenie& inne) const { return czas > inne.czas; }
+    };
+
+    std::priority_queue<Zdarzenie, std::vector<Zdarzenie>, std::greater<Zdarzenie>> kolejka;
+    std::vector<double> czasDysku;
+    std::vector<unsigned> licznik;
+    std::vector<int> ostatniPartner; // dysk z ostatniego zderzenia; -1 po odbiciu od krawędzi
+    bool aktualny = false;
+    double teraz = 0;
+
+    // Siatka: listy dysków w komórkach, komórka i pozycja na liście dla każdego dysku
+    float w = 0, h = 0, bok = 0;
+    int kolumny = 0, wiersze = 0;
+    std::vector<std::vector<int>> komorki;
+    std::vector<int> komorkaX, komorkaY, miejsce;
+
+    long long zderzenia = 0, odbicia = 0, przejscia = 0, nieaktualne = 0, przebudowy = 0, przerwane = 0;
+
+    void przygotuj(const MagazynDyskow& d, float szerokosc, float wysokosc, float maksSrednica) {
+        const int n = static_cast<int>(d.rozmiar());
+        w = szerokosc;
+        h = wysokosc;
+        bok = std::max(maksSrednica, 1.0f);
+        kolumny = std::max(1, static_cast<int>(w / bok));
+        wiersze = std::max(1, static_cast<int>(h / bok));
+        komorki.assign(static_cast<std::size_t>(kolumny) * wiersze, std::vector<int>());
+        komorkaX.resize(n);
+        komorkaY.resize(n);
+        miejsce.resize(n);
+        czasDysku.assign(n, teraz);
+        licznik.assign(n, 0);
+        ostatniPartner.assign(n, -1);
+        kolejka = decltype(kolejka)();
+        for (int i = 0; i < n; ++i) {
+            komorkaX[i] = std::min(std::max(static_cast<int>((d.x[i] + d.promien[i]) / bok), 0), kolumny - 1);
+            komorkaY[i] = std::min(std::max(static_cast<int>((d.y[i] + d.promien[i]) / bok), 0), wiersze - 1);
+            wstaw(i);
+        }
+        for (int i = 0; i < n; ++i) przewidz(d, i, true);
+        aktualny = true;
+        ++przebudowy;
+    }
+
+    void wstaw(int i) {
+        std::vector<int>& lista = komorki[komorkaY[i] * kolumny + komorkaX[i]];
+        miejsce[i] = static_cast<int>(lista.size());
+        lista.push_back(i);
+    }
+
+    void usun(int i) {
+        std::vector<int>& lista = komorki[komorkaY[i] * kolumny + komorkaX[i]];
+        int ostatni = lista.back();
+        lista[miejsce[i]] = ostatni;
+        miejsce[ostatni] = miejsce[i];
+        lista.pop_back();
+    }
+
+    // Przesuwa dysk do chwili teraz
+    void dogon(MagazynDyskow& d, int i) {
+        double t = teraz - czasDysku[i];
+        d.x[i] += static_cast<float>(d.vx[i] * t);
+        d.y[i] += static_cast<float>(d.vy[i] * t);
+        czasDysku[i] = teraz;
+    }
+
+    void dodaj(double czas, int i, int j) {
+        kolejka.push(Zdarzenie{czas, i, j, licznik[i], j >= 0 ? licznik[j] : 0u});
+    }
+
+    // Wszystkie przyszłe zdarzenia dysku i (zsynchronizowanego z chwilą teraz); przy
+    // przebudowie pary przewidywane są tylko raz, od dysku o mniejszym indeksie
+    void przewidz(const MagazynDyskow& d, int i, bool tylkoWiekszeIndeksy = false) {
+        const double x = d.x[i], y = d.y[i], vx = d.vx[i], vy = d.vy[i];
+        const double srednica = 2.0 * d.promien[i];
+
+        // Krawędzie: ruch lewego górnego rogu w [0, w - średnica] x [0, h - średnica]
+        double tx = vx > 0 ? (w - srednica - x) / vx : vx < 0 ? -x / vx : INFINITY;
+        double ty = vy > 0 ? (h - srednica - y) / vy : vy < 0 ? -y / vy : INFINITY;
+        if (tx < ty) dodaj(teraz + std::max(tx, 0.0), i, SCIANA_X);
+        else if (ty < INFINITY) dodaj(teraz + std::max(ty, 0.0), i, SCIANA_Y);
+
+        // Granice komórki środka; skrajne komórki sięgają do krawędzi
+        const double cx = x + d.promien[i], cy = y + d.promien[i];
+        double kx = INFINITY, ky = INFINITY;
+        if (vx > 0 && komorkaX[i] + 1 < kolumny) kx = ((komorkaX[i] + 1) * static_cast<double>(bok) - cx) / vx;
+        else if (vx < 0 && komorkaX[i] > 0) kx = (komorkaX[i] * static_cast<double>(bok) - cx) / vx;
+        if (vy > 0 && komorkaY[i] + 1 < wiersze) ky = ((komorkaY[i] + 1) * static_cast<double>(bok) - cy) / vy;
+        else if (vy < 0 && komorkaY[i] > 0) ky = (komorkaY[i] * static_cast<double>(bok) - cy) / vy;
+        if (kx < ky) dodaj(teraz + std::max(kx, 0.0), i, KOMORKA_X);
+        else if (ky < INFINITY) dodaj(teraz + std::max(ky, 0.0), i, KOMORKA_Y);
+
+        for (int sy = std::max(komorkaY[i] - 1, 0); sy <= std::min(komorkaY[i] + 1, wiersze - 1); ++sy) {
+            for (int sx = std::max(komorkaX[i] - 1, 0); sx <= std::min(komorkaX[i] + 1, kolumny - 1); ++sx) {
+                for (int j : komorki[sy * kolumny + sx]) {
+                    if (j == i || (tylkoWiekszeIndeksy && j < i)) continue;
+                    double t = czasZderzenia(d, i, j);
+                    if (t < INFINITY) dodaj(teraz + t, i, j);
+                }
+            }
+        }
+    }
+
+    // Względne położenie i prędkość środków j względem i w chwili teraz, w double - jeden test
+    // zbliżania (b < 0) dla przewidywania i dla samego zderzenia
+    struct Wzgledne {
+        double dx, dy, dvx, dvy, b;
+    };
+
+    Wzgledne wzgledne(const MagazynDyskow& d, int i, int j) const {
+        double ti = teraz - czasDysku[i], tj = teraz - czasDysku[j];
+        Wzgledne r;
+        r.dx = (d.x[j] + d.vx[j] * tj + d.promien[j]) - (d.x[i] + d.vx[i] * ti + d.promien[i]);
+        r.dy = (d.y[j] + d.vy[j] * tj + d.promien[j]) - (d.y[i] + d.vy[i] * ti + d.promien[i]);
+        r.dvx = static_cast<double>(d.vx[j]) - d.vx[i];
+        r.dvy = static_cast<double>(d.vy[j]) - d.vy[i];
+        r.b = r.dx * r.dvx + r.dy * r.dvy;
+        return r;
+    }
+
+    // Czas do zetknięcia dysków i oraz j liczony od chwili teraz; INFINITY, gdy się nie zbliżają.
+    // Stykające się i zbliżające dyski zderzają się od razu - chyba że właśnie zderzyły się
+    // ze sobą, a zbliżanie to resztka zaokrągleń. Głęboko nachodzące przelatują przez siebie.
+    double czasZderzenia(const MagazynDyskow& d, int i, int j) const {
+        Wzgledne r = wzgledne(d, i, j);
+        if (r.b >= 0) return INFINITY;
+        double sigma = static_cast<double>(d.promien[i]) + d.promien[j];
+        double odleglosc2 = r.dx * r.dx + r.dy * r.dy - sigma * sigma;
+        if (odleglosc2 <= 0) {
+            if (odleglosc2 < -NALOZENIE * sigma * sigma) return INFINITY;
+            return ostatniPartner[i] == j ? INFINITY : 0;
+        }
+        double vv = r.dvx * r.dvx + r.dvy * r.dvy;
+        double wyroznik = r.b * r.b - vv * odleglosc2;
+        if (wyroznik < 0) return INFINITY;
+        return odleglosc2 / (-r.b + std::sqrt(wyroznik)); // = (-b - sqrt) / vv bez utraty cyfr
+    }
+
+    // Zderzenie sprężyste wzdłuż linii środków - ten sam wzór co zderzeniaSprężyste,
+    // z tym samym testem zbliżania co czasZderzenia
+    void zderz(MagazynDyskow& d, int i, int j) {
+        Wzgledne r = wzgledne(d, i, j);
+        double odleglosc = std::sqrt(r.dx * r.dx + r.dy * r.dy);
+        if (r.b >= 0 || odleglosc <= 0) return;
+        double nx = r.dx / odleglosc, ny = r.dy / odleglosc;
+        double odbicie = 2.0 * (r.b / odleglosc) / (static_cast<double>(d.masa[i]) + d.masa[j]);
+        d.vx[i] += static_cast<float>(odbicie * d.masa[j] * nx);
+        d.vy[i] += static_cast<float>(odbicie * d.masa[j] * ny);
+        d.vx[j] -= static_cast<float>(odbicie * d.masa[i] * nx);
+        d.vy[j] -= static_cast<float>(odbicie * d.masa[i] * ny);
+    }
+
+    void odbij(MagazynDyskow& d, int i, bool poziomo) {
+        float srednica = 2 * d.promien[i];
+        if (poziomo) {
+            d.x[i] = std::min(std::max(d.x[i], 0.0f), w - srednica);
+            d.vx[i] = -d.vx[i];
+        } else {
+            d.y[i] = std::min(std::max(d.y[i], 0.0f), h - srednica);
+            d.vy[i] = -d.vy[i];
+        }
+    }
+
+    void przenies(const MagazynDyskow& d, int i, bool poziomo) {
+        usun(i);
+        if (poziomo) komorkaX[i] += d.vx[i] > 0 ? 1 : -1;
+        else komorkaY[i] += d.vy[i] > 0 ? 1 : -1;
+        wstaw(i);
+    }
+};
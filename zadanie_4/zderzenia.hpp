@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include "../wspolne/magazyn_dyskow.hpp"
+
+// Zderzenia sprężyste; zwraca true, gdy dyski się stykają
+inline bool zderzeniaSprężyste(MagazynDyskow& d, int i, int j) {
+    sf::Vector2f delta = d.pozycja(i) - d.pozycja(j);
+    float odleglosc = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    float promienSum = d.promien[i] + d.promien[j];
+
+    if (odleglosc < promienSum) {
+        sf::Vector2f normal = delta / odleglosc;
+        sf::Vector2f relV(d.vx[i] - d.vx[j], d.vy[i] - d.vy[j]);
+        float prędkośćWzdłużNormalnej = relV.x * normal.x + relV.y * normal.y;
+
+        if (prędkośćWzdłużNormalnej < 0) {
+            float odbicie = 2.0f * prędkośćWzdłużNormalnej / (d.masa[i] + d.masa[j]);
+            sf::Vector2f zmiana1 = odbicie * d.masa[j] * normal;
+            sf::Vector2f zmiana2 = odbicie * d.masa[i] * normal;
+            d.vx[i] -= zmiana1.x; d.vy[i] -= zmiana1.y;
+            d.vx[j] += zmiana2.x; d.vy[j] += zmiana2.y;
+        }
+        return true;
+    }
+    return false;
+}
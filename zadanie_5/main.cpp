@@ -1,156 +1,247 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp>
 #include <vector>
-#include <cmath>
-#include <random>
-
-// Struktura wektora 3D
-struct Vector3D {
-    float x, y, z;
-
-    Vector3D(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
-
-    Vector3D operator+(const Vector3D& other) const {
-        return Vector3D(x + other.x, y + other.y, z + other.z);
-    }
-
-    Vector3D operator-(const Vector3D& other) const {
-        return Vector3D(x - other.x, y - other.y, z - other.z);
-    }
-
-    Vector3D operator*(float scalar) const {
-        return Vector3D(x * scalar, y * scalar, z * scalar);
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include "particles.hpp"
+#include "../wspolne/renderer_kol.hpp"
+#include "../wspolne/argumenty.hpp"
+#include "../wspolne/tryb_wsadowy.hpp"
+#include "../wspolne/staly_krok.hpp"
+#include "../wspolne/trajektoria.hpp"
+#include "../wspolne/profiler.hpp"
+#include "../wspolne/zasoby.hpp"
+#include "../wspolne/porzadek_mortona.hpp"
+#include "../wspolne/liczniki_sprzetowe.hpp"
+
+// Krok symulacji [s], limit kroków na klatkę i domyślna emisja [cząsteczki/s]
+const float fixedStep = 1.0f / 60.0f;
+const int maxSubsteps = 5;
+const float emissionRate = 1800.0f;
+
+// Suma kontrolna pozycji i prędkości wszystkich cząsteczek
+std::uint64_t stateChecksum(const Emitter& emitter) {
+    SumaKontrolna checksum;
+    for (const auto& particle : emitter.getParticles()) {
+        checksum.dodaj(particle.position.x);
+        checksum.dodaj(particle.position.y);
+        checksum.dodaj(particle.velocity.x);
+        checksum.dodaj(particle.velocity.y);
     }
+    return checksum.wartosc();
+}
 
-    Vector3D& operator+=(const Vector3D& other) {
-        x += other.x;
-        y += other.y;
-        z += other.z;
-        return *this;
+// Cząsteczki i koła jednym wywołaniem draw
+void drawScene(sf::RenderTarget& target, RendererKol& batch, const Emitter& emitter, const ObstacleGrid& obstacles,
+               float alpha = 1.0f) {
+    target.clear();
+    batch.zacznij(0);
+    emitter.draw(batch, alpha);
+    for (const auto& circle : obstacles.getCircles()) {
+        batch.dodaj(circle.position.x - circle.radius, circle.position.y - circle.radius, circle.radius,
+                    sf::Color(255, 255, 255, 50));
     }
+    batch.rysuj(target);
+}
 
-    float length() const {
-        return std::sqrt(x * x + y * y + z * z);
-    }
+// Zajętość puli: bieżąca / szczytowa / budżet oraz liczba odrzuconych cząsteczek
+std::string poolOccupancy(const ParticlePool& pool) {
+    return "pool " + std::to_string(pool.size()) + " / peak " + std::to_string(pool.peakSize()) +
+           " / budget " + std::to_string(pool.capacity()) + ", rejected " + std::to_string(pool.rejectedCount());
+}
 
-    Vector3D normalized() const {
-        float len = length();
-        return len > 0 ? Vector3D(x / len, y / len, z / len) : Vector3D(0, 0, 0);
+// Koła o promieniu 50 rozłożone losowo w oknie - przeszkody dla trybu wsadowego
+ObstacleGrid randomObstacles(int count, std::uint64_t seed) {
+    ObstacleGrid obstacles;
+    GeneratorLosowy generator(seed);
+    for (int i = 0; i < count; ++i) {
+        float cx = generator.przedzial(0, 800);
+        float cy = generator.przedzial(0, 600);
+        obstacles.add(Circle(Vector3D(cx, cy, 0), 50.0f));
     }
-};
-
-// Struktura koła
-struct Circle {
-    Vector3D position;
-    float radius;
+    return obstacles;
+}
 
-    Circle(const Vector3D& pos, float r) : position(pos), radius(r) {}
+// Migawka sceny: cząsteczki emitera, przeszkody i numer kroku (faza --reorder); błędy są
+// wypisywane na stderr
+bool saveScene(const std::string& path, bool compress, const Emitter& emitter, const ObstacleGrid& obstacles,
+               std::uint64_t step) {
+    ZapisMigawki snapshot("zadanie_5");
+    emitter.save(snapshot);
+    obstacles.save(snapshot);
+    snapshot.wartosc("step", step);
+    if (snapshot.zapisz(path, compress)) return true;
+    std::fprintf(stderr, "%s: nie udało się zapisać migawki\n", path.c_str());
+    return false;
+}
 
-    bool contains(const Vector3D& point) const {
-        return (point - position).length() <= radius;
+// Bez numeru kroku (starsza migawka) kroki liczone są od zera
+bool loadScene(const std::string& path, Emitter& emitter, ObstacleGrid& obstacles, std::uint64_t& step) {
+    OdczytMigawki snapshot;
+    if (!snapshot.otworz(path)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), snapshot.komunikat().c_str());
+        return false;
     }
-};
-
-// Klasa cząsteczki
-class Particle {
-public:
-    Vector3D position;
-    Vector3D velocity;
-    sf::Color color;
-    float lifeTime;
-    float size;
-
-    Particle(const Vector3D& pos, const Vector3D& vel, sf::Color col, float life, float sz)
-        : position(pos), velocity(vel), color(col), lifeTime(life), size(sz) {}
-
-    void update(float dt, const Vector3D& wind, const Vector3D& attractionPoint, const std::vector<Circle>& circles) {
-        Vector3D attractionForce = (attractionPoint - position).normalized() * 20.0f;
-        velocity += (wind + attractionForce) * dt;
-        position += velocity * dt;
-
-        for (const auto& circle : circles) {
-            if (circle.contains(position)) {
-                // Odbicie: proste odbicie w przeciwnym kierunku
-                velocity = velocity * -0.8f; // Tłumienie odbicia
-                position += velocity * dt;
-            }
-        }
-
-        lifeTime -= dt;
+    if (!emitter.load(snapshot) || !obstacles.load(snapshot)) {
+        std::fprintf(stderr, "%s: migawka nie zawiera cząsteczek i przeszkód\n", path.c_str());
+        return false;
     }
+    if (!snapshot.wartosc("step", step)) step = 0;
+    return true;
+}
 
-    bool isAlive() const {
-        return lifeTime > 0;
-    }
-};
-
-// Klasa emitera
-class Emitter {
-    std::vector<Particle> particles;
-    Vector3D position;
-
-public:
-    Emitter(const Vector3D& pos) : position(pos) {}
-
-    void emit(int count) {
-        for (int i = 0; i < count; ++i) {
-            Vector3D velocity = randomVelocity() * 50.0f;
-            sf::Color color(rand() % 255, rand() % 255, rand() % 255, 150);
-            float lifeTime = static_cast<float>(rand() % 3 + 3);
-            float size = rand() % 2 + 1;
-            particles.emplace_back(position, velocity, color, lifeTime, size);
-        }
+// Klatka trajektorii: pola cząsteczek przepisywane do tablic SoA tylko w zapisywanych krokach,
+// w kolejności emisji - pula przestawia cząsteczki przy usuwaniu martwych i przy --reorder
+void recordStep(ZapisTrajektorii& trajectory, std::uint64_t step, const Emitter& emitter, std::vector<float>& columns,
+                std::vector<std::uint32_t>& rows) {
+    if (!trajectory.zapisze(step)) return;
+    const ParticlePool& particles = emitter.getParticles();
+    std::size_t n = particles.size();
+    rows.resize(n);
+    for (std::size_t i = 0; i < n; ++i) rows[i] = static_cast<std::uint32_t>(i);
+    std::sort(rows.begin(), rows.end(), [&](std::uint32_t a, std::uint32_t b) { return particles[a].id < particles[b].id; });
+    columns.resize(4 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Particle& particle = particles[rows[i]];
+        columns[i] = particle.position.x;
+        columns[n + i] = particle.position.y;
+        columns[2 * n + i] = particle.velocity.x;
+        columns[3 * n + i] = particle.velocity.y;
     }
+    trajectory.krok(step, n, columns.data(), columns.data() + n, columns.data() + 2 * n, columns.data() + 3 * n);
+}
 
-    void update(float dt, const Vector3D& wind, const Vector3D& attractionPoint, const std::vector<Circle>& circles) {
-        for (auto& particle : particles) {
-            particle.update(dt, wind, attractionPoint, circles);
+// Uruchomienie: particle_system [--seed S] [--budget N] [--rate N] [--load PLIK] [--save PLIK [--compress]]
+//               [--headless KROKI [--circles N] [--brute] [--render KLATKI]]
+//               [--trajectory PLIK [--every N] [--fields x,y,vx,vy] [--csv PLIK]]
+//               [--profile] [--trace PLIK] [--reorder KROKI] [--cache-misses]
+int main(int argc, char* argv[]) {
+    Argumenty args(argc, argv);
+    wlaczProfiler(args);
+    LicznikiSprzetowe counters;
+    wlaczLiczniki(counters, args);
+    std::uint64_t seed = static_cast<std::uint64_t>(args.liczbaCalkowita("seed", 1));
+    std::size_t budget = static_cast<std::size_t>(args.liczbaCalkowita("budget", Emitter::DEFAULT_BUDGET));
+    LicznikEmisji emission(args.liczba("rate", emissionRate));
+
+    // --load: scena z migawki zamiast pustej; --save: zapis po przebiegu wsadowym
+    // albo klawiszem F5 w oknie (F9 wczytuje ponownie)
+    const std::string savePath = args.tekst("save", "zadanie_5.migawka");
+    const std::string loadPath = args.tekst("load", savePath);
+    const bool compress = args.jest("compress");
+
+    // Trajektoria: stan po każdym kroku; liczba cząsteczek zmienia się między klatkami
+    ZapisTrajektorii trajectory;
+    if (!otworzTrajektorie(trajectory, args, fixedStep)) return 1;
+    std::vector<float> trajectoryColumns;
+    std::vector<std::uint32_t> trajectoryRows;
+    std::uint64_t step = 0;
+
+    // --reorder N: co N kroków cząsteczki porządkowane wzdłuż krzywej Mortona
+    PorzadekMortona order;
+    order.co = static_cast<int>(args.liczbaCalkowita("reorder", 0));
+
+    // Tryb wsadowy: stały krok 1/60 s, bez wiatru; --circles N dodaje N przeszkód,
+    // --brute sprawdza wszystkie koła zamiast komórki z siatki (ten sam wynik, do porównań)
+    if (args.jest("headless")) {
+        long long steps = args.liczbaCalkowita("headless", 1000);
+        bool brute = args.jest("brute");
+        const float dt = fixedStep;
+        Emitter emitter(Vector3D(400, 300, 0), budget);
+        emitter.seed(seed);
+        ObstacleGrid obstacles = randomObstacles(static_cast<int>(args.liczbaCalkowita("circles", 0)), seed);
+        if (args.jest("load") && !loadScene(loadPath, emitter, obstacles, step)) return 1;
+        PomiarWsadowy measurement;
+        measurement.start();
+        counters.start();
+        for (long long i = 0; i < steps; ++i) {
+            profiler().poczatekKlatki();
+            if (order.pora(step)) {
+                Strefa zone("reorder");
+                emitter.reorder(order);
+            }
+            {
+                Strefa zone("emit");
+                emitter.emit(emission.ile(dt));
+            }
+            {
+                Strefa zone("update");
+                if (brute) emitter.update(dt, Vector3D(0, 0, 0), Vector3D(400, 300, 0), obstacles.getCircles());
+                else emitter.update(dt, Vector3D(0, 0, 0), Vector3D(400, 300, 0), obstacles);
+            }
+            recordStep(trajectory, ++step, emitter, trajectoryColumns, trajectoryRows);
+            profiler().koniecKlatki();
+            measurement.krok(emitter.getParticles().size());
         }
-        particles.erase(std::remove_if(particles.begin(), particles.end(),
-                                       [](const Particle& p) { return !p.isAlive(); }),
-                        particles.end());
-    }
-
-    void draw(sf::RenderWindow& window) {
-        for (const auto& particle : particles) {
-            sf::CircleShape shape(particle.size);
-            shape.setPosition(particle.position.x, particle.position.y);
-            shape.setFillColor(particle.color);
-            window.draw(shape);
+        counters.stop();
+        measurement.stop();
+        std::printf("particles: %s, circles = %zu (%s)\n", poolOccupancy(emitter.getParticles()).c_str(),
+                    obstacles.size(), brute ? "full scan" : "grid");
+        if (order.co > 0) std::printf("morton order: every %d steps, reorders = %lld\n", order.co, order.liczbaPorzadkowan());
+        if (args.jest("cache-misses")) counters.wypisz(static_cast<double>(measurement.liczbaKrokowCial()));
+        measurement.wypisz("zadanie_5", stateChecksum(emitter));
+        if (!zakonczTrajektorie(trajectory, args) || !zakonczProfiler(args)) return 1;
+        if (args.jest("save") && !saveScene(savePath, compress, emitter, obstacles, step)) return 1;
+
+        // --render N: dodatkowo N klatek rysowanych do tekstury poza ekranem
+        if (args.jest("render")) {
+            RendererKol batch;
+            PomiarRenderowania renderMeasurement;
+            if (!renderMeasurement.utworz(800, 600)) return 1;
+            long long frames = args.liczbaCalkowita("render", 100);
+            for (long long i = 0; i < frames; ++i) {
+                renderMeasurement.klatka([&](sf::RenderTarget& target) { drawScene(target, batch, emitter, obstacles); });
+            }
+            renderMeasurement.wypisz(batch.wywolania());
         }
+        return 0;
     }
 
-private:
-    Vector3D randomVelocity() {
-        static std::default_random_engine generator;
-        static std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
-        return Vector3D(distribution(generator), distribution(generator), 0);
-    }
-};
-
-int main() {
     sf::RenderWindow window(sf::VideoMode(800, 600), "Particle System with Circles", sf::Style::Default, sf::ContextSettings(24));
     window.setFramerateLimit(60);
 
-    Emitter emitter(Vector3D(400, 300, 0));
+    Emitter emitter(Vector3D(400, 300, 0), budget);
+    emitter.seed(seed);
     Vector3D wind(0, 0, 0);
     Vector3D attractionPoint(400, 300, 0);
 
-    std::vector<Circle> circles;
+    ObstacleGrid obstacles;
+    if (args.jest("load") && !loadScene(loadPath, emitter, obstacles, step)) return 1;
+    RendererKol batch;
+    Zasoby resources(argv[0]);
+    NakladkaProfilera overlay(resources.czcionka("arial.ttf"));
+    overlay.widoczna = profiler().wlaczony();
 
+    StalyKrok scheduler(fixedStep, maxSubsteps);
     sf::Clock clock;
+    int frame = 0;
     while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    attractionPoint = Vector3D(event.mouseButton.x, event.mouseButton.y, 0);
+        profiler().poczatekKlatki();
+        {
+            Strefa zone("events");
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    window.close();
                 }
-                if (event.mouseButton.button == sf::Mouse::Middle) {
-                    circles.emplace_back(Vector3D(event.mouseButton.x, event.mouseButton.y, 0), 50.0f); // Koło o promieniu 50
+                // F5 / F9 - zapis / odczyt migawki, F3 - nakładka profilera
+                if (event.type == sf::Event::KeyPressed) {
+                    if (event.key.code == sf::Keyboard::F5) saveScene(savePath, compress, emitter, obstacles, step);
+                    else if (event.key.code == sf::Keyboard::F9) loadScene(loadPath, emitter, obstacles, step);
+                    else if (event.key.code == sf::Keyboard::F3) {
+                        profiler().wlacz(true);
+                        overlay.widoczna = !overlay.widoczna;
+                    }
+                }
+                if (event.type == sf::Event::MouseButtonPressed) {
+                    if (event.mouseButton.button == sf::Mouse::Left) {
+                        attractionPoint = Vector3D(event.mouseButton.x, event.mouseButton.y, 0);
+                    }
+                    if (event.mouseButton.button == sf::Mouse::Middle) {
+                        obstacles.add(Circle(Vector3D(event.mouseButton.x, event.mouseButton.y, 0), 50.0f)); // Koło o promieniu 50
+                    }
                 }
             }
         }
@@ -164,23 +255,41 @@ int main() {
         else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) wind.y = 20.0f;
         else wind.y = 0;
 
-        float dt = clock.restart().asSeconds();
-
-        emitter.emit(30);
-        emitter.update(dt, wind, attractionPoint, circles);
-
-        window.clear();
-        emitter.draw(window);
+        // Stały krok niezależny od FPS; po wolnej klatce co najwyżej maxSubsteps kroków
+        int steps = scheduler.klatka(clock.restart().asSeconds());
+        for (int i = 0; i < steps; ++i) {
+            if (order.pora(step)) {
+                Strefa zone("reorder");
+                emitter.reorder(order);
+            }
+            {
+                Strefa zone("emit");
+                emitter.emit(emission.ile(scheduler.krok()));
+            }
+            {
+                Strefa zone("update");
+                emitter.update(scheduler.krok(), wind, attractionPoint, obstacles);
+            }
+            recordStep(trajectory, ++step, emitter, trajectoryColumns, trajectoryRows);
+        }
 
-        for (const auto& circle : circles) {
-            sf::CircleShape shape(circle.radius);
-            shape.setPosition(circle.position.x - circle.radius, circle.position.y - circle.radius);
-            shape.setFillColor(sf::Color(255, 255, 255, 50));
-            window.draw(shape);
+        // Zajętość puli w tytule okna co 30 klatek
+        if (++frame % 30 == 0) {
+            window.setTitle("Particle System with Circles [" + poolOccupancy(emitter.getParticles()) + "]");
         }
 
-        window.display();
+        {
+            Strefa zone("draw");
+            drawScene(window, batch, emitter, obstacles, scheduler.alfa());
+            overlay.rysuj(window, emitter.getParticles().size(), batch.wywolania());
+        }
+        {
+            Strefa zone("display");
+            window.display();
+        }
+        profiler().koniecKlatki();
     }
 
-    return 0;
+    bool ok = zakonczTrajektorie(trajectory, args);
+    return zakonczProfiler(args) && ok ? 0 : 1;
 }
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "../wspolne/renderer_kol.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/migawka.hpp"
+#include "../wspolne/porzadek_mortona.hpp"
+
+// Struktura wektora 3D
+struct Vector3D {
+    float x, y, z;
+
+    Vector3D(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+
+    Vector3D operator+(const Vector3D& other) const {
+        return Vector3D(x + other.x, y + other.y, z + other.z);
+    }
+
+    Vector3D operator-(const Vector3D& other) const {
+        return Vector3D(x - other.x, y - other.y, z - other.z);
+    }
+
+    Vector3D operator*(float scalar) const {
+        return Vector3D(x * scalar, y * scalar, z * scalar);
+    }
+
+    Vector3D& operator+=(const Vector3D& other) {
+        x += other.x;
+        y += other.y;
+        z += other.z;
+        return *this;
+    }
+
+    float length() const {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+
+    Vector3D normalized() const {
+        float len = length();
+        return len > 0 ? Vector3D(x / len, y / len, z / len) : Vector3D(0, 0, 0);
+    }
+};
+
+// Struktura koła
+struct Circle {
+    Vector3D position;
+    float radius;
+
+    Circle(const Vector3D& pos, float r) : position(pos), radius(r) {}
+
+    bool contains(const Vector3D& point) const {
+        return (point - position).length() <= radius;
+    }
+};
+
+// Indeks przeszkód: jednorodna siatka nad obszarem okna. Każde koło jest wpisywane do
+// wszystkich komórek, które przecina jego kwadrat opisany, więc cząsteczka sprawdza tylko
+// koła ze swojej komórki. Koła dodawane są przyrostowo, a listy komórek pozostają
+// posortowane po indeksie koła - kolejność testów jest taka sama jak przy pełnym przeglądzie.
+// Punkty spoza obszaru trafiają do najbliższej komórki brzegowej, tak jak koła wystające poza okno.
+class ObstacleGrid {
+    std::vector<Circle> circles;
+    std::vector<std::vector<int>> cells;
+    float cellSize;
+    int columns, rows;
+
+public:
+    ObstacleGrid(float width = 800, float height = 600, float cellSize = 25)
+        : cellSize(cellSize),
+          columns(std::max(1, static_cast<int>(std::ceil(width / cellSize)))),
+          rows(std::max(1, static_cast<int>(std::ceil(height / cellSize)))) {
+        cells.resize(static_cast<std::size_t>(columns) * rows);
+    }
+
+    void add(const Circle& circle) {
+        int index = static_cast<int>(circles.size());
+        circles.push_back(circle);
+
+        // Margines chroni przed zaokrągleniem w Circle::contains na samej krawędzi
+        float r = circle.radius * 1.0001f + 1e-3f;
+        int x0 = column(circle.position.x - r), x1 = column(circle.position.x + r);
+        int y0 = row(circle.position.y - r), y1 = row(circle.position.y + r);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                cells[static_cast<std::size_t>(y) * columns + x].push_back(index);
+            }
+        }
+    }
+
+    void clear() {
+        circles.clear();
+        for (auto& cell : cells) cell.clear();
+    }
+
+    void save(ZapisMigawki& snapshot) const {
+        std::vector<float> x, y, radius;
+        for (const auto& circle : circles) {
+            x.push_back(circle.position.x);
+            y.push_back(circle.position.y);
+            radius.push_back(circle.radius);
+        }
+        snapshot.kopia("circles.x", x.data(), x.size());
+        snapshot.kopia("circles.y", y.data(), y.size());
+        snapshot.kopia("circles.radius", radius.data(), radius.size());
+    }
+
+    // Koła z migawki zastępują bieżące; false (bez zmian), gdy brakuje bloków
+    bool load(const OdczytMigawki& snapshot) {
+        std::size_t n = 0, ny = 0, nr = 0;
+        const float* x = snapshot.blok<float>("circles.x", n);
+        const float* y = snapshot.blok<float>("circles.y", ny);
+        const float* radius = snapshot.blok<float>("circles.radius", nr);
+        if (!x || !y || !radius || ny != n || nr != n) return false;
+        clear();
+        for (std::size_t i = 0; i < n; ++i) add(Circle(Vector3D(x[i], y[i], 0), radius[i]));
+        return true;
+    }
+
+    const std::vector<Circle>& getCircles() const { return circles; }
+    std::size_t size() const { return circles.size(); }
+    const Circle& operator[](int i) const { return circles[i]; }
+
+    int cellOf(const Vector3D& point) const {
+        return row(point.y) * columns + column(point.x);
+    }
+
+    // Rosnące indeksy kół, które mogą zawierać punkt z komórki
+    const std::vector<int>& candidates(int cell) const { return cells[cell]; }
+
+private:
+    int clampedCell(float coordinate, int count) const {
+        // max przed min - NaN kończy w komórce 0 zamiast w niezdefiniowanym rzutowaniu
+        float c = std::max(0.0f, coordinate / cellSize);
+        return static_cast<int>(std::min(c, static_cast<float>(count - 1)));
+    }
+    int column(float x) const { return clampedCell(x, columns); }
+    int row(float y) const { return clampedCell(y, rows); }
+};
+
+// Klasa cząsteczki
+class Particle {
+public:
+    Vector3D position;
+    Vector3D previousPosition; // pozycja przed ostatnim krokiem - do interpolacji przy rysowaniu
+    Vector3D velocity;
+    sf::Color color;
+    float lifeTime;
+    float size;
+    std::uint64_t id = 0; // numer emisji - trwały mimo przenoszenia cząsteczki w puli
+
+    Particle(const Vector3D& pos, const Vector3D& vel, sf::Color col, float life, float sz)
+        : position(pos), previousPosition(pos), velocity(vel), color(col), lifeTime(life), size(sz) {}
+
+    // Pozycja między poprzednim a bieżącym krokiem, alpha w [0, 1]
+    Vector3D interpolated(float alpha) const {
+        return previousPosition + (position - previousPosition) * alpha;
+    }
+
+    void update(float dt, const Vector3D& wind, const Vector3D& attractionPoint, const std::vector<Circle>& circles) {
+        previousPosition = position;
+        Vector3D attractionForce = (attractionPoint - position).normalized() * 20.0f;
+        velocity += (wind + attractionForce) * dt;
+        position += velocity * dt;
+
+        for (const auto& circle : circles) {
+            if (circle.contains(position)) {
+                // Odbicie: proste odbicie w przeciwnym kierunku
+                velocity = velocity * -0.8f; // Tłumienie odbicia
+                position += velocity * dt;
+            }
+        }
+
+        lifeTime -= dt;
+    }
+
+    // To samo co wyżej, ale z kołami z indeksu: sprawdzane są tylko koła z komórki cząsteczki.
+    // Po odbiciu cząsteczka może przejść do innej komórki - wtedy przegląd jest kontynuowany
+    // w nowej komórce od kolejnego indeksu koła, więc wynik jest identyczny z pełnym przeglądem.
+    void update(float dt, const Vector3D& wind, const Vector3D& attractionPoint, const ObstacleGrid& obstacles) {
+        previousPosition = position;
+        Vector3D attractionForce = (attractionPoint - position).normalized() * 20.0f;
+        velocity += (wind + attractionForce) * dt;
+        position += velocity * dt;
+
+        int nextCircle = 0;
+        int cell = obstacles.cellOf(position);
+        for (bool moved = obstacles.size() > 0; moved;) {
+            moved = false;
+            const std::vector<int>& list = obstacles.candidates(cell);
+            for (auto it = std::lower_bound(list.begin(), list.end(), nextCircle); it != list.end(); ++it) {
+                nextCircle = *it + 1;
+                if (obstacles[*it].contains(position)) {
+                    velocity = velocity * -0.8f;
+                    position += velocity * dt;
+                    int newCell = obstacles.cellOf(position);
+                    if (newCell != cell) {
+                        cell = newCell;
+                        moved = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        lifeTime -= dt;
+    }
+
+    bool isAlive() const {
+        return lifeTime > 0;
+    }
+};
+
+// Pula cząsteczek o stałej pojemności. Pamięć jest rezerwowana raz, więc dodawanie
+// nigdy nie alokuje, a martwa cząsteczka jest usuwana w O(1) przez przeniesienie
+// ostatniej żywej na jej miejsce (kolejność cząsteczek nie jest zachowywana - kolejność
+// emisji odtwarza Particle::id).
+class ParticlePool {
+    std::vector<Particle> particles;
+    std::vector<Particle> reordered; // bufor przestawiania, też z pojemnością budżetu
+    std::size_t budget;
+    std::size_t peak = 0;
+    std::size_t rejected = 0;
+
+public:
+    explicit ParticlePool(std::size_t budget) : budget(budget) {
+        particles.reserve(budget);
+    }
+
+    // Zwraca false, gdy pula jest pełna - cząsteczka jest wtedy odrzucana
+    bool add(const Particle& particle) {
+        if (particles.size() >= budget) {
+            ++rejected;
+            return false;
+        }
+        particles.push_back(particle);
+        peak = std::max(peak, particles.size());
+        return true;
+    }
+
+    // Zlicza cząsteczki, które nie zostały nawet utworzone, bo pula była pełna
+    void reject(std::size_t count) {
+        rejected += count;
+    }
+
+    void clear() {
+        particles.clear();
+    }
+
+    void kill(std::size_t i) {
+        if (i + 1 != particles.size()) particles[i] = particles.back();
+        particles.pop_back();
+    }
+
+    // Nowa kolejność cząsteczek: na miejsce k trafia dawna cząsteczka order[k]
+    void reorder(const std::vector<std::uint32_t>& order) {
+        reordered.clear();
+        reordered.reserve(budget);
+        for (std::uint32_t i : order) reordered.push_back(particles[i]);
+        particles.swap(reordered);
+    }
+
+    // Zmiana budżetu; przy zmniejszeniu nadmiarowe cząsteczki są odrzucane od końca
+    void setBudget(std::size_t newBudget) {
+        budget = newBudget;
+        if (particles.size() > budget) particles.erase(particles.begin() + budget, particles.end());
+        particles.reserve(budget);
+    }
+
+    std::size_t size() const { return particles.size(); }
+    std::size_t capacity() const { return budget; }
+    std::size_t peakSize() const { return peak; }
+    std::size_t rejectedCount() const { return rejected; }
+
+    Particle& operator[](std::size_t i) { return particles[i]; }
+    const Particle& operator[](std::size_t i) const { return particles[i]; }
+    std::vector<Particle>::const_iterator begin() const { return particles.begin(); }
+    std::vector<Particle>::const_iterator end() const { return particles.end(); }
+};
+
+// Klasa emitera
+class Emitter {
+    ParticlePool particles;
+    Vector3D position;
+    GeneratorLosowy generator;
+    std::uint64_t emitted = 0; // numer kolejnej cząsteczki = numer jej strumienia losowego
+    std::vector<float> sortX, sortY;
+
+public:
+    // 30 cząsteczek na klatkę przy 60 FPS, żyjących do 5 s
+    static constexpr std::size_t DEFAULT_BUDGET = 9000;
+
+    Emitter(const Vector3D& pos, std::size_t budget = DEFAULT_BUDGET) : particles(budget), position(pos) {}
+
+    void seed(std::uint64_t value) {
+        generator.seed(value);
+        emitted = 0;
+    }
+
+    const ParticlePool& getParticles() const {
+        return particles;
+    }
+
+    void setBudget(std::size_t budget) {
+        particles.setBudget(budget);
+    }
+
+    void emit(int count) {
+        for (int i = 0; i < count; ++i) {
+            if (particles.size() >= particles.capacity()) {
+                particles.reject(count - i);
+                break;
+            }
+            // Każda cząsteczka losuje z własnego strumienia - wynik zależy tylko od ziarna
+            // i numeru cząsteczki, więc emisję można by rozdzielić między wątki
+            std::uint64_t id = emitted++;
+            GeneratorLosowy random = generator.strumien(id);
+            Vector3D velocity = Vector3D(random.przedzial(-1.0f, 1.0f), random.przedzial(-1.0f, 1.0f), 0) * 50.0f;
+            sf::Color color(random.calkowita(255), random.calkowita(255), random.calkowita(255), 150);
+            float lifeTime = static_cast<float>(random.calkowita(3) + 3);
+            float size = static_cast<float>(random.calkowita(2) + 1);
+            Particle particle(position, velocity, color, lifeTime, size);
+            particle.id = id;
+            particles.add(particle);
+        }
+    }
+
+    // Cząsteczki jako bloki SoA oraz stan losowania - po wczytaniu emisja jest kontynuowana
+    // tymi samymi liczbami, jakie padłyby bez zapisu
+    void save(ZapisMigawki& snapshot) const {
+        auto column = [&](const char* name, auto field) {
+            std::vector<decltype(field(particles[0]))> values;
+            values.reserve(particles.size());
+            for (const auto& particle : particles) values.push_back(field(particle));
+            snapshot.kopia(name, values.data(), values.size());
+        };
+        column("particles.x", [](const Particle& p) { return p.position.x; });
+        column("particles.y", [](const Particle& p) { return p.position.y; });
+        column("particles.previous_x", [](const Particle& p) { return p.previousPosition.x; });
+        column("particles.previous_y", [](const Particle& p) { return p.previousPosition.y; });
+        column("particles.vx", [](const Particle& p) { return p.velocity.x; });
+        column("particles.vy", [](const Particle& p) { return p.velocity.y; });
+        column("particles.color", [](const Particle& p) { return p.color; });
+        column("particles.life_time", [](const Particle& p) { return p.lifeTime; });
+        column("particles.size", [](const Particle& p) { return p.size; });
+        column("particles.id", [](const Particle& p) { return p.id; });
+        snapshot.wartosc("emitter.seed", generator.ziarno());
+        snapshot.wartosc("emitter.emitted", emitted);
+    }
+
+    // false (emiter bez zmian), gdy brakuje bloków; budżet rośnie, jeśli cząsteczek jest więcej
+    bool load(const OdczytMigawki& snapshot) {
+        std::size_t n = 0, count[8];
+        const float* x = snapshot.blok<float>("particles.x", n);
+        const float* y = snapshot.blok<float>("particles.y", count[0]);
+        const float* previousX = snapshot.blok<float>("particles.previous_x", count[1]);
+        const float* previousY = snapshot.blok<float>("particles.previous_y", count[2]);
+        const float* vx = snapshot.blok<float>("particles.vx", count[3]);
+        const float* vy = snapshot.blok<float>("particles.vy", count[4]);
+        const sf::Color* color = snapshot.blok<sf::Color>("particles.color", count[5]);
+        const float* lifeTime = snapshot.blok<float>("particles.life_time", count[6]);
+        const float* size = snapshot.blok<float>("particles.size", count[7]);
+        // Numery emisji są opcjonalne - bez nich cząsteczki dostają kolejne numery w kolejności z pliku
+        std::size_t idCount = 0;
+        const std::uint64_t* id = snapshot.blok<std::uint64_t>("particles.id", idCount);
+        if (idCount != n) id = nullptr;
+        std::uint64_t seedValue = 0, emittedValue = 0;
+        if (!x || !y || !previousX || !previousY || !vx || !vy || !color || !lifeTime || !size ||
+            std::count(count, count + 8, n) != 8 || !snapshot.wartosc("emitter.seed", seedValue) ||
+            !snapshot.wartosc("emitter.emitted", emittedValue)) {
+            return false;
+        }
+
+        if (n > particles.capacity()) particles.setBudget(n);
+        particles.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            Particle particle(Vector3D(x[i], y[i], 0), Vector3D(vx[i], vy[i], 0), color[i], lifeTime[i], size[i]);
+            particle.previousPosition = Vector3D(previousX[i], previousY[i], 0);
+            particle.id = id ? id[i] : i;
+            particles.add(particle);
+        }
+        generator.seed(seedValue);
+        emitted = emittedValue;
+        return true;
+    }
+
+    // Cząsteczki wzdłuż krzywej Mortona: po kolei w pamięci leżą cząsteczki z tych samych
+    // komórek przeszkód. Numer emisji przenosi się razem z cząsteczką, więc nic poza pulą
+    // nie trzeba przenumerowywać.
+    void reorder(PorzadekMortona& order) {
+        std::size_t n = particles.size();
+        sortX.resize(n);
+        sortY.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            sortX[i] = particles[i].position.x;
+            sortY[i] = particles[i].position.y;
+        }
+        particles.reorder(order.uporzadkuj(sortX.data(), sortY.data(), n));
+    }
+
+    // Obstacles to ObstacleGrid albo std::vector<Circle> (pełny przegląd, do porównań)
+    template <typename Obstacles>
+    void update(float dt, const Vector3D& wind, const Vector3D& attractionPoint, const Obstacles& obstacles) {
+        // Cząsteczka przeniesiona z końca na miejsce martwej jest aktualizowana w tym samym przebiegu
+        std::size_t i = 0;
+        while (i < particles.size()) {
+            particles[i].update(dt, wind, attractionPoint, obstacles);
+            if (particles[i].isAlive()) ++i;
+            else particles.kill(i);
+        }
+    }
+
+    // Cząsteczki trafiają do wspólnej partii renderera zamiast osobnych sf::CircleShape;
+    // alpha to ułamek kroku od ostatniej aktualizacji (1 - stan bieżący)
+    void draw(RendererKol& batch, float alpha = 1.0f) const {
+        for (const auto& particle : particles) {
+            Vector3D p = particle.interpolated(alpha);
+            batch.dodaj(p.x, p.y, particle.size, particle.color);
+        }
+    }
+};
@@ -2,7 +2,16 @@
 #include <SFML/OpenGL.hpp>
 #include <vector>
 #include <cmath>
-#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include "../wspolne/renderer_kol.hpp"
+#include "../wspolne/argumenty.hpp"
+#include "../wspolne/tryb_wsadowy.hpp"
+#include "../wspolne/staly_krok.hpp"
+#include "../wspolne/zasoby.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/profiler.hpp"
 
 // Struktura wektora 3D
 struct Vector3D {
@@ -43,15 +52,21 @@ struct Vector3D {
 class Particle {
 public:
     Vector3D position;
+    Vector3D previousPosition; // pozycja przed ostatnim krokiem - do interpolacji przy rysowaniu
     Vector3D velocity;
     sf::Color color;
     float lifeTime;
     float size;
 
     Particle(const Vector3D& pos, const Vector3D& vel, sf::Color col, float life, float sz)
-        : position(pos), velocity(vel), color(col), lifeTime(life), size(sz) {}
+        : position(pos), previousPosition(pos), velocity(vel), color(col), lifeTime(life), size(sz) {}
+
+    Vector3D interpolated(float alpha) const {
+        return previousPosition + (position - previousPosition) * alpha;
+    }
 
     void update(float dt) {
+        previousPosition = position;
         position += velocity * dt;
 
 
@@ -73,38 +88,59 @@ public:
 class Snowflake {
 public:
     Vector3D position;
+    Vector3D previousPosition;
     Vector3D velocity;
     float size;
+    GeneratorLosowy random; // własny strumień płatka - płatki można aktualizować niezależnie
 
-    Snowflake(const Vector3D& pos, const Vector3D& vel, float sz)
-        : position(pos), velocity(vel), size(sz) {}
+    Snowflake(const Vector3D& pos, const Vector3D& vel, float sz, const GeneratorLosowy& rng)
+        : position(pos), previousPosition(pos), velocity(vel), size(sz), random(rng) {}
 
     void update(float dt) {
+        previousPosition = position;
         position += velocity * dt;
-        velocity.x += ((rand() % 3) - 1) * 0.1f;
+        velocity.x += (static_cast<int>(random.calkowita(3)) - 1) * 0.1f;
+    }
+
+    // Przeniesienie na górę ekranu w losowe miejsce, bez interpolowania przez cały ekran
+    void respawn() {
+        position.y = 0;
+        position.x = static_cast<float>(random.calkowita(800));
+        previousPosition = position;
     }
 
-    void draw(sf::RenderWindow& window) const {
-        sf::CircleShape shape(size);
-        shape.setPosition(position.x, position.y);
-        shape.setFillColor(sf::Color(255, 255, 255, 200));
-        window.draw(shape);
+    void draw(RendererKol& batch, float alpha = 1.0f) const {
+        Vector3D p = previousPosition + (position - previousPosition) * alpha;
+        batch.dodaj(p.x, p.y, size, sf::Color(255, 255, 255, 200));
     }
 };
 
 class Emitter {
     std::vector<Particle> particles;
     Vector3D position;
+    GeneratorLosowy generator;
+    std::uint64_t emitted = 0; // numer kolejnej cząsteczki = numer jej strumienia losowego
 
 public:
     Emitter(const Vector3D& pos) : position(pos) {}
 
+    void seed(std::uint64_t value) {
+        generator.seed(value);
+        emitted = 0;
+    }
+
+    const std::vector<Particle>& getParticles() const {
+        return particles;
+    }
+
     void emit(int count) {
         for (int i = 0; i < count; ++i) {
-            Vector3D velocity = randomVelocity() * 50.0f;
+            GeneratorLosowy random = generator.strumien(emitted++);
+            // Cząsteczki lecą w górę
+            Vector3D velocity = Vector3D(random.przedzial(-1.0f, 1.0f), -random.ulamek(), 0) * 50.0f;
             sf::Color color(255, 0, 0, 150);
-            float lifeTime = static_cast<float>(rand() % 3 + 2); 
-            float size = rand() % 2 + 2;
+            float lifeTime = static_cast<float>(random.calkowita(3) + 2);
+            float size = static_cast<float>(random.calkowita(2) + 2);
             particles.emplace_back(position, velocity, color, lifeTime, size);
         }
     }
@@ -118,90 +154,227 @@ public:
                         particles.end());
     }
 
-    void draw(sf::RenderWindow& window) {
+    // Cząsteczki trafiają do wspólnej partii renderera zamiast osobnych sf::CircleShape
+    void draw(RendererKol& batch, float alpha = 1.0f) const {
         for (const auto& particle : particles) {
-            sf::CircleShape shape(particle.size);
-            shape.setPosition(particle.position.x, particle.position.y);
-            shape.setFillColor(particle.color);
-            window.draw(shape);
+            Vector3D p = particle.interpolated(alpha);
+            batch.dodaj(p.x, p.y, particle.size, particle.color);
         }
     }
-
-private:
-    Vector3D randomVelocity() {
-        static std::default_random_engine generator;
-        static std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
-        return Vector3D(distribution(generator), -std::abs(distribution(generator)), 0); // Particles move upward
-    }
 };
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode(800, 600), "Particle System - Fire and Snow", sf::Style::Default, sf::ContextSettings(24));
-    window.setFramerateLimit(60);
-
-    Emitter fireEmitter(Vector3D(400, 580, 0));
-
+std::vector<Snowflake> createSnowflakes(std::uint64_t seed) {
     std::vector<Snowflake> snowflakes;
-    for (int i = 0; i < 200; ++i) { 
-        float x = rand() % 800;
-        float y = rand() % 600;
+    GeneratorLosowy generator(seed);
+    for (int i = 0; i < 200; ++i) {
+        GeneratorLosowy random = generator.strumien(i);
+        float x = static_cast<float>(random.calkowita(800));
+        float y = static_cast<float>(random.calkowita(600));
         Vector3D position(x, y, 0);
         Vector3D velocity(0, 30.0f, 0);
-        float size = rand() % 3 + 1;
-        snowflakes.emplace_back(position, velocity, size);
+        float size = static_cast<float>(random.calkowita(3) + 1);
+        snowflakes.emplace_back(position, velocity, size, random);
     }
+    return snowflakes;
+}
 
-    sf::Clock clock;
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-        }
-
-        float dt = clock.restart().asSeconds();
+// Krok symulacji [s], limit kroków na klatkę i emisja ognia [cząsteczki/s]
+const float fixedStep = 1.0f / 60.0f;
+const int maxSubsteps = 5;
+const float fireRate = 900.0f;
 
-        fireEmitter.emit(15);
-        fireEmitter.update(dt);
+// Jeden krok sceny: ogień i śnieg
+void updateScene(Emitter& fireEmitter, LicznikEmisji& emission, std::vector<Snowflake>& snowflakes, float dt) {
+    Strefa fireZone("fire");
+    fireEmitter.emit(emission.ile(dt));
+    fireEmitter.update(dt);
+    fireZone.zakoncz();
 
-        for (auto& snowflake : snowflakes) {
-            snowflake.update(dt);
+    Strefa snowZone("snow");
+    for (auto& snowflake : snowflakes) {
+        snowflake.update(dt);
 
-            if (snowflake.position.y > 600) {
-                snowflake.position.y = 0;
-                snowflake.position.x = rand() % 800;
-            }
+        if (snowflake.position.y > 600) {
+            snowflake.respawn();
         }
+    }
+}
 
-        window.clear();
+// Suma kontrolna pozycji i prędkości cząsteczek ognia oraz płatków śniegu
+std::uint64_t stateChecksum(const Emitter& fireEmitter, const std::vector<Snowflake>& snowflakes) {
+    SumaKontrolna checksum;
+    for (const auto& particle : fireEmitter.getParticles()) {
+        checksum.dodaj(particle.position.x);
+        checksum.dodaj(particle.position.y);
+        checksum.dodaj(particle.velocity.x);
+        checksum.dodaj(particle.velocity.y);
+    }
+    for (const auto& snowflake : snowflakes) {
+        checksum.dodaj(snowflake.position.x);
+        checksum.dodaj(snowflake.position.y);
+        checksum.dodaj(snowflake.velocity.x);
+    }
+    return checksum.wartosc();
+}
 
+// Elementy sceny, które się nie zmieniają - tworzone raz przy starcie
+struct SceneStatics {
+    sf::RectangleShape ground;
+    sf::Text signature;
 
-        sf::RectangleShape ground(sf::Vector2f(800, 20));
+    explicit SceneStatics(const sf::Font& font)
+        : ground(sf::Vector2f(800, 20)), signature("Mateusz Sierakowski", font, 24) {
         ground.setPosition(0, 580);
         ground.setFillColor(sf::Color(139, 69, 19));
-        window.draw(ground);
+        signature.setFillColor(sf::Color::White);
+        signature.setPosition(10, 10);
+    }
+};
+
+// Ziemia, ogień i śnieg jedną partią renderera, podpis na wierzchu
+void drawScene(sf::RenderTarget& target, RendererKol& batch, const SceneStatics& statics, const Emitter& fireEmitter,
+               const std::vector<Snowflake>& snowflakes, float alpha = 1.0f) {
+    target.clear();
+    target.draw(statics.ground);
+
+    batch.zacznij(0);
+    fireEmitter.draw(batch, alpha);
+    for (const auto& snowflake : snowflakes) {
+        snowflake.draw(batch, alpha);
+    }
+    batch.rysuj(target);
+
+    target.draw(statics.signature);
+}
 
-        fireEmitter.draw(window);
-        
-        for (const auto& snowflake : snowflakes) {
-            snowflake.draw(window);
+// Dawny sposób rysowania: czcionka, ziemia i podpis tworzone od nowa w każdej klatce.
+// Zostawiony tylko do porównania czasu klatki (--render N --uncached).
+bool drawSceneUncached(sf::RenderTarget& target, RendererKol& batch, const Emitter& fireEmitter,
+                       const std::vector<Snowflake>& snowflakes) {
+    sf::Font font;
+    if (!font.loadFromFile("arial.ttf")) return false;
+    SceneStatics statics(font);
+    drawScene(target, batch, statics, fireEmitter, snowflakes);
+    return true;
+}
+
+// Uruchomienie: holiday_scene [--seed S] [--headless KROKI [--render KLATKI [--uncached]]]
+//                             [--profile] [--trace PLIK]
+int main(int argc, char* argv[]) {
+    Argumenty args(argc, argv);
+    wlaczProfiler(args);
+    Zasoby resources(argv[0]);
+    std::uint64_t seed = static_cast<std::uint64_t>(args.liczbaCalkowita("seed", 1));
+
+    Emitter fireEmitter(Vector3D(400, 580, 0));
+    fireEmitter.seed(seed);
+    LicznikEmisji fireEmission(fireRate);
+    // Osobne ziarno śniegu, żeby strumienie płatków nie pokrywały się ze strumieniami ognia
+    std::vector<Snowflake> snowflakes = createSnowflakes(mieszaj(seed));
+
+    // Tryb wsadowy: stały krok 1/60 s, bez okna
+    if (args.jest("headless")) {
+        long long steps = args.liczbaCalkowita("headless", 1000);
+        PomiarWsadowy measurement;
+        measurement.start();
+        for (long long i = 0; i < steps; ++i) {
+            profiler().poczatekKlatki();
+            updateScene(fireEmitter, fireEmission, snowflakes, fixedStep);
+            profiler().koniecKlatki();
+            measurement.krok(fireEmitter.getParticles().size() + snowflakes.size());
+        }
+        measurement.stop();
+        std::printf("particles = %zu, snowflakes = %zu\n", fireEmitter.getParticles().size(), snowflakes.size());
+        measurement.wypisz("zadanie_6", stateChecksum(fireEmitter, snowflakes));
+        if (!zakonczProfiler(args)) return 1;
+
+        // --render N: dodatkowo N klatek rysowanych do tekstury poza ekranem;
+        // --uncached wczytuje czcionkę w każdej klatce, jak przed wprowadzeniem Zasoby
+        if (args.jest("render")) {
+            const sf::Font* font = resources.czcionka("arial.ttf");
+            if (!font) {
+                std::fprintf(stderr, "Nie można wczytać czcionki arial.ttf\n");
+                return 1;
+            }
+            SceneStatics statics(*font);
+            bool uncached = args.jest("uncached");
+            RendererKol batch;
+            PomiarRenderowania renderMeasurement;
+            if (!renderMeasurement.utworz(800, 600)) return 1;
+            long long frames = args.liczbaCalkowita("render", 100);
+            for (long long i = 0; i < frames; ++i) {
+                bool drawn = renderMeasurement.klatka([&](sf::RenderTarget& target) {
+                    if (uncached) return drawSceneUncached(target, batch, fireEmitter, snowflakes);
+                    drawScene(target, batch, statics, fireEmitter, snowflakes);
+                    return true;
+                });
+                // Klatka bez czcionki nie jest porównywalna - pomiar przerwany, a nie zaniżony
+                if (!drawn) {
+                    std::fprintf(stderr, "Nie można wczytać czcionki arial.ttf w klatce %lld - pomiar przerwany\n", i);
+                    return 1;
+                }
+            }
+            // Ziemia i podpis to dwa dodatkowe wywołania draw na klatkę
+            std::printf("%s: ", uncached ? "czcionka w każdej klatce" : "zasoby wczytane raz");
+            renderMeasurement.wypisz(batch.wywolania() + 2 * static_cast<std::size_t>(frames));
         }
+        return 0;
+    }
 
+    // Zasoby sprawdzane przed otwarciem okna - brak pliku kończy program od razu, a nie w pętli
+    const sf::Font* font = resources.czcionka("arial.ttf");
+    if (!font) {
+        std::fprintf(stderr, "Nie można wczytać czcionki arial.ttf\n");
+        return 1;
+    }
+    SceneStatics statics(*font);
 
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
+    sf::RenderWindow window(sf::VideoMode(800, 600), "Particle System - Fire and Snow", sf::Style::Default, sf::ContextSettings(24));
+    window.setFramerateLimit(60);
+
+    RendererKol batch;
+    NakladkaProfilera overlay(font);
+    overlay.widoczna = profiler().wlaczony();
+    std::size_t frame = 0;
+
+    StalyKrok scheduler(fixedStep, maxSubsteps);
+    sf::Clock clock;
+    while (window.isOpen()) {
+        profiler().poczatekKlatki();
+        {
+            Strefa zone("events");
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    window.close();
+                }
+                // F3 - nakładka profilera
+                if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                    profiler().wlacz(true);
+                    overlay.widoczna = !overlay.widoczna;
+                }
+            }
+        }
 
-            return -1;
+        // Stały krok niezależny od FPS; po wolnej klatce co najwyżej maxSubsteps kroków
+        int steps = scheduler.klatka(clock.restart().asSeconds());
+        for (int i = 0; i < steps; ++i) {
+            updateScene(fireEmitter, fireEmission, snowflakes, scheduler.krok());
         }
-        
-        sf::Text signature("Mateusz Sierakowski", font, 24);
-        signature.setFillColor(sf::Color::White);
-        signature.setPosition(10, 10);
-        window.draw(signature);
 
-        window.display();
+        {
+            Strefa zone("draw");
+            drawScene(window, batch, statics, fireEmitter, snowflakes, scheduler.alfa());
+            // Ziemia i podpis to dwa dodatkowe wywołania draw na klatkę
+            overlay.rysuj(window, fireEmitter.getParticles().size() + snowflakes.size(),
+                          batch.wywolania() + 2 * ++frame);
+        }
+        {
+            Strefa zone("display");
+            window.display();
+        }
+        profiler().koniecKlatki();
     }
 
-    return 0;
+    return zakonczProfiler(args) ? 0 : 1;
 }
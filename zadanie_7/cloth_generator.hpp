@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <cstdio>
+#include "cloth_graph.hpp"
+
+// Parametry prostokątnej tkaniny: siatka columns x rows cząsteczek co spacing pikseli,
+// z lewym górnym rogiem w origin i pierwszymi pinnedRows wierszami przypiętymi
+struct ClothParams {
+    int columns = 20;
+    int rows = 15;
+    float spacing = 20.f;
+    sf::Vector2f origin = sf::Vector2f(200.f, 50.f);
+    int pinnedRows = 1;
+
+    // Sztywności sprężyn: strukturalne (sąsiedzi w wierszu i kolumnie), ścinające
+    // (przekątne komórki) i zginające (co drugi węzeł); 0 wyłącza dany rodzaj
+    float structural = 0.1f;
+    float shear = 0.05f;
+    float bend = 0.02f;
+};
+
+// Rozmiar w formacie "KOLUMNYxWIERSZE", np. "100x80"; false przy błędnym formacie
+inline bool parseClothSize(const std::string& text, ClothParams& params) {
+    int columns = 0, rows = 0;
+    if (std::sscanf(text.c_str(), "%dx%d", &columns, &rows) != 2 || columns < 1 || rows < 1) return false;
+    params.columns = columns;
+    params.rows = rows;
+    return true;
+}
+
+// Dodaje tkaninę do grafu; cząsteczka (x, y) siatki ma indeks first + y * columns + x
+inline void buildCloth(ClothGraph& graph, const ClothParams& params) {
+    const std::uint32_t first = static_cast<std::uint32_t>(graph.getParticles().size());
+    for (int y = 0; y < params.rows; ++y) {
+        for (int x = 0; x < params.columns; ++x) {
+            graph.addParticle(params.origin + sf::Vector2f(x * params.spacing, y * params.spacing),
+                              y < params.pinnedRows);
+        }
+    }
+
+    auto at = [&](int x, int y) { return first + static_cast<std::uint32_t>(y * params.columns + x); };
+    for (int y = 0; y < params.rows; ++y) {
+        for (int x = 0; x < params.columns; ++x) {
+            if (params.structural > 0) {
+                if (x + 1 < params.columns) graph.addSpring(at(x, y), at(x + 1, y), params.structural);
+                if (y + 1 < params.rows) graph.addSpring(at(x, y), at(x, y + 1), params.structural);
+            }
+            if (params.shear > 0 && x + 1 < params.columns && y + 1 < params.rows) {
+                graph.addSpring(at(x, y), at(x + 1, y + 1), params.shear);
+                graph.addSpring(at(x + 1, y), at(x, y + 1), params.shear);
+            }
+            if (params.bend > 0) {
+                if (x + 2 < params.columns) graph.addSpring(at(x, y), at(x + 2, y), params.bend);
+                if (y + 2 < params.rows) graph.addSpring(at(x, y), at(x, y + 2), params.bend);
+            }
+        }
+    }
+}
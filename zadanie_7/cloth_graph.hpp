@@ -0,0 +1,251 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "spring_model.hpp"
+#include "../wspolne/migawka.hpp"
+
+// Uchwyt cząsteczki: numer slotu i jego pokolenie. Po usunięciu cząsteczki pokolenie
+// slotu rośnie, więc stare uchwyty przestają być ważne zamiast wskazywać inną cząsteczkę.
+struct ParticleHandle {
+    std::uint32_t slot = UINT32_MAX;
+    std::uint32_t generation = 0;
+
+    bool operator==(const ParticleHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const ParticleHandle& other) const { return !(*this == other); }
+};
+
+// Graf cząsteczek i sprężyn. Cząsteczki i sprężyny leżą ciasno w dwóch wektorach,
+// a sprężyny trzymają indeksy cząsteczek zamiast wskaźników. Usuwanie w obu wektorach
+// przenosi ostatni element na zwolnione miejsce, a indeksy są poprawiane przez listy
+// sprężyn każdej cząsteczki - koszt zależy od stopnia wierzchołka, nie od rozmiaru grafu.
+// Indeksy są ważne tylko do następnej zmiany grafu; na dłużej służą uchwyty.
+class ClothGraph {
+public:
+    ParticleHandle addParticle(sf::Vector2f position, bool pinned = false) {
+        std::uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+        slots[slot].index = static_cast<std::uint32_t>(particles.size());
+        particles.emplace_back(position, pinned);
+        slotOfParticle.push_back(slot);
+        springsOfParticle.emplace_back();
+        return ParticleHandle{slot, slots[slot].generation};
+    }
+
+    bool valid(ParticleHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation &&
+               slots[handle.slot].index != INVALID;
+    }
+
+    // Indeks cząsteczki w getParticles() albo -1 dla nieważnego uchwytu
+    int indexOf(ParticleHandle handle) const {
+        return valid(handle) ? static_cast<int>(slots[handle.slot].index) : -1;
+    }
+
+    ParticleHandle handleOf(std::size_t index) const {
+        std::uint32_t slot = slotOfParticle[index];
+        return ParticleHandle{slot, slots[slot].generation};
+    }
+
+    Particle* get(ParticleHandle handle) {
+        return valid(handle) ? &particles[slots[handle.slot].index] : nullptr;
+    }
+
+    // Sprężyna o długości spoczynkowej równej bieżącej odległości; pętle i nieważne uchwyty są odrzucane
+    bool addSpring(ParticleHandle a, ParticleHandle b, float stiffness = 0.1f) {
+        int i = indexOf(a), j = indexOf(b);
+        if (i < 0 || j < 0 || i == j) return false;
+        addSpring(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j), stiffness);
+        return true;
+    }
+
+    void addSpring(std::uint32_t i, std::uint32_t j, float stiffness = 0.1f) {
+        std::uint32_t s = static_cast<std::uint32_t>(springs.size());
+        springs.emplace_back(particles, i, j, stiffness);
+        ++revision;
+        springsOfParticle[i].push_back(s);
+        springsOfParticle[j].push_back(s);
+    }
+
+    // Usuwa cząsteczkę razem z jej sprężynami
+    bool removeParticle(ParticleHandle handle) {
+        int found = indexOf(handle);
+        if (found < 0) return false;
+        std::uint32_t p = static_cast<std::uint32_t>(found);
+
+        while (!springsOfParticle[p].empty()) {
+            removeSpring(springsOfParticle[p].back());
+        }
+
+        // Ostatnia cząsteczka zajmuje miejsce usuniętej - jej sprężyny dostają nowy indeks
+        std::uint32_t last = static_cast<std::uint32_t>(particles.size() - 1);
+        if (p != last) {
+            for (std::uint32_t s : springsOfParticle[last]) {
+                if (springs[s].a == last) springs[s].a = p;
+                if (springs[s].b == last) springs[s].b = p;
+            }
+            particles[p] = particles[last];
+            springsOfParticle[p].swap(springsOfParticle[last]);
+            slotOfParticle[p] = slotOfParticle[last];
+            slots[slotOfParticle[p]].index = p;
+        }
+        particles.pop_back();
+        springsOfParticle.pop_back();
+        slotOfParticle.pop_back();
+        ++revision;
+
+        slots[handle.slot].index = INVALID;
+        ++slots[handle.slot].generation;
+        freeSlots.push_back(handle.slot);
+        return true;
+    }
+
+    void removeSpring(std::uint32_t s) {
+        detach(springs[s].a, s);
+        detach(springs[s].b, s);
+
+        std::uint32_t last = static_cast<std::uint32_t>(springs.size() - 1);
+        if (s != last) {
+            springs[s] = springs[last];
+            replace(springs[s].a, last, s);
+            replace(springs[s].b, last, s);
+        }
+        springs.pop_back();
+        ++revision;
+    }
+
+    std::vector<Particle>& getParticles() { return particles; }
+    const std::vector<Particle>& getParticles() const { return particles; }
+    const std::vector<Spring>& getSprings() const { return springs; }
+    const std::vector<std::uint32_t>& springsOf(std::size_t index) const { return springsOfParticle[index]; }
+
+    // Rośnie przy każdej zmianie sprężyn lub indeksów cząsteczek - kopie sprężyn trzymane
+    // poza grafem (np. w solverze) porównują go, by wiedzieć, kiedy się przebudować
+    std::uint64_t getRevision() const { return revision; }
+
+    // Cząsteczki i sprężyny jako bloki SoA; uchwyty nie są zapisywane
+    void save(ZapisMigawki& snapshot) const {
+        std::vector<float> x, y, previousX, previousY, restLength, stiffness;
+        std::vector<std::uint8_t> pinned;
+        std::vector<std::uint32_t> a, b;
+        for (const auto& p : particles) {
+            x.push_back(p.position.x);
+            y.push_back(p.position.y);
+            previousX.push_back(p.previousPosition.x);
+            previousY.push_back(p.previousPosition.y);
+            pinned.push_back(p.isPinned ? 1 : 0);
+        }
+        for (const auto& spring : springs) {
+            a.push_back(spring.a);
+            b.push_back(spring.b);
+            restLength.push_back(spring.restLength);
+            stiffness.push_back(spring.stiffness);
+        }
+        snapshot.kopia("particles.x", x.data(), x.size());
+        snapshot.kopia("particles.y", y.data(), y.size());
+        snapshot.kopia("particles.previous_x", previousX.data(), previousX.size());
+        snapshot.kopia("particles.previous_y", previousY.data(), previousY.size());
+        snapshot.kopia("particles.pinned", pinned.data(), pinned.size());
+        snapshot.kopia("springs.a", a.data(), a.size());
+        snapshot.kopia("springs.b", b.data(), b.size());
+        snapshot.kopia("springs.rest_length", restLength.data(), restLength.size());
+        snapshot.kopia("springs.stiffness", stiffness.data(), stiffness.size());
+    }
+
+    // Zastępuje cały graf; false (graf bez zmian), gdy brakuje bloków albo sprężyna wskazuje
+    // poza cząsteczki. Wcześniejsze uchwyty przestają być ważne.
+    bool load(const OdczytMigawki& snapshot) {
+        std::size_t n = 0, m = 0, count[7];
+        const float* x = snapshot.blok<float>("particles.x", n);
+        const float* y = snapshot.blok<float>("particles.y", count[0]);
+        const float* previousX = snapshot.blok<float>("particles.previous_x", count[1]);
+        const float* previousY = snapshot.blok<float>("particles.previous_y", count[2]);
+        const std::uint8_t* pinned = snapshot.blok<std::uint8_t>("particles.pinned", count[3]);
+        const std::uint32_t* a = snapshot.blok<std::uint32_t>("springs.a", m);
+        const std::uint32_t* b = snapshot.blok<std::uint32_t>("springs.b", count[4]);
+        const float* restLength = snapshot.blok<float>("springs.rest_length", count[5]);
+        const float* stiffness = snapshot.blok<float>("springs.stiffness", count[6]);
+        if (!x || !y || !previousX || !previousY || !pinned || !a || !b || !restLength || !stiffness ||
+            std::count(count, count + 4, n) != 4 || std::count(count + 4, count + 7, m) != 3) {
+            return false;
+        }
+        for (std::size_t s = 0; s < m; ++s) {
+            if (a[s] >= n || b[s] >= n || a[s] == b[s]) return false;
+        }
+
+        // Stare sloty dostają nowe pokolenie, więc żaden dawny uchwyt nie wskaże nowej cząsteczki
+        for (auto& slot : slots) {
+            slot.index = INVALID;
+            ++slot.generation;
+        }
+        if (slots.size() < n) slots.resize(n);
+        freeSlots.clear();
+        for (std::size_t i = slots.size(); i-- > n;) freeSlots.push_back(static_cast<std::uint32_t>(i));
+
+        particles.clear();
+        particles.reserve(n);
+        slotOfParticle.resize(n);
+        springsOfParticle.assign(n, std::vector<std::uint32_t>());
+        for (std::size_t i = 0; i < n; ++i) {
+            particles.emplace_back(sf::Vector2f(x[i], y[i]), pinned[i] != 0);
+            particles.back().previousPosition = sf::Vector2f(previousX[i], previousY[i]);
+            slotOfParticle[i] = static_cast<std::uint32_t>(i);
+            slots[i].index = static_cast<std::uint32_t>(i);
+        }
+        springs.clear();
+        springs.reserve(m);
+        for (std::size_t s = 0; s < m; ++s) {
+            springs.emplace_back(particles, a[s], b[s], stiffness[s]);
+            springs.back().restLength = restLength[s];
+            springsOfParticle[a[s]].push_back(static_cast<std::uint32_t>(s));
+            springsOfParticle[b[s]].push_back(static_cast<std::uint32_t>(s));
+        }
+        ++revision;
+        return true;
+    }
+
+    // Jedna iteracja więzów, sprężyny po kolei w pamięci
+    void applyConstraints() {
+        for (const auto& spring : springs) {
+            spring.applyConstraint(particles);
+        }
+    }
+
+private:
+    static const std::uint32_t INVALID = UINT32_MAX;
+
+    struct Slot {
+        std::uint32_t index = INVALID;
+        std::uint32_t generation = 0;
+    };
+
+    std::vector<Particle> particles;
+    std::vector<std::uint32_t> slotOfParticle;
+    std::vector<std::vector<std::uint32_t>> springsOfParticle;
+    std::vector<Spring> springs;
+    std::vector<Slot> slots;
+    std::vector<std::uint32_t> freeSlots;
+    std::uint64_t revision = 0;
+
+    void detach(std::uint32_t particle, std::uint32_t spring) {
+        auto& list = springsOfParticle[particle];
+        auto it = std::find(list.begin(), list.end(), spring);
+        if (it != list.end()) {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+
+    void replace(std::uint32_t particle, std::uint32_t from, std::uint32_t to) {
+        auto& list = springsOfParticle[particle];
+        std::replace(list.begin(), list.end(), from, to);
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+#include "cloth_graph.hpp"
+#include "../wspolne/pula_watkow.hpp"
+
+// Równoległy solver więzów sprężyn. Sprężyny są zachłannie kolorowane tak, aby żadne
+// dwie sprężyny jednego koloru nie miały wspólnej cząsteczki - partia jednego koloru
+// może być wtedy liczona przez wiele wątków naraz bez wyścigów. Partie idą po kolei
+// (Gauss-Seidel między kolorami, Jacobi wewnątrz koloru), więc wynik nie zależy
+// od liczby wątków.
+class ConstraintSolver {
+public:
+    // Maksymalna liczba iteracji na krok i próg względnego odkształcenia, poniżej którego
+    // solver kończy wcześniej (0 - zawsze wszystkie iteracje)
+    int iterations = 1;
+    float tolerance = 0.0f;
+
+    // Rozmiar bloku sprężyn przydzielanego jednemu wątkowi
+    static const std::size_t BLOCK_SIZE = 2048;
+
+    struct Stats {
+        int iterations = 0;   // wykonane iteracje w ostatnim kroku
+        float maxStrain = 0;  // największe |d - L| / d w ostatniej iteracji
+    };
+
+    // Przebudowa partii, jeśli sprężyny w grafie zmieniły się od ostatniego razu. Z listą
+    // active partie obejmują tylko podane sprężyny (np. niespiących wysp), a activeRevision
+    // mówi, kiedy lista się zmieniła; nullptr - wszystkie sprężyny w kolejności z grafu.
+    void update(const ClothGraph& graph, const std::vector<std::uint32_t>* active = nullptr,
+                std::uint64_t activeRevision = 0) {
+        if (built && graph.getRevision() == revision && activeRevision == builtActiveRevision) return;
+        built = true;
+        revision = graph.getRevision();
+        builtActiveRevision = activeRevision;
+
+        const auto& springs = graph.getSprings();
+        std::vector<std::uint32_t> all;
+        if (!active) {
+            all.resize(springs.size());
+            for (std::size_t s = 0; s < springs.size(); ++s) all[s] = static_cast<std::uint32_t>(s);
+            active = &all;
+        }
+        std::vector<int> colour(springs.size(), -1);
+        std::vector<char> used;
+        int colours = 0;
+        for (std::uint32_t s : *active) {
+            // Kolory zajęte przez sprężyny obu końców; pierwszy wolny trafia do tej sprężyny
+            used.assign(colours + 1, 0);
+            for (std::uint32_t end : {springs[s].a, springs[s].b}) {
+                for (std::uint32_t other : graph.springsOf(end)) {
+                    if (colour[other] >= 0) used[colour[other]] = 1;
+                }
+            }
+            int c = 0;
+            while (used[c]) ++c;
+            colour[s] = c;
+            colours = std::max(colours, c + 1);
+        }
+
+        // Sprężyny posortowane kolorami, każda partia ciągła w pamięci
+        batchStart.assign(colours + 1, 0);
+        for (std::uint32_t s : *active) ++batchStart[colour[s] + 1];
+        for (int c = 0; c < colours; ++c) batchStart[c + 1] += batchStart[c];
+        std::vector<std::size_t> next(batchStart.begin(), batchStart.end() - 1);
+        sorted.clear();
+        sorted.reserve(active->size());
+        std::vector<std::size_t> order(active->size());
+        for (std::uint32_t s : *active) order[next[colour[s]]++] = s;
+        for (std::size_t s : order) sorted.push_back(springs[s]);
+    }
+
+    Stats solve(ClothGraph& graph, PulaWatkow& pool, const std::vector<std::uint32_t>* active = nullptr,
+                std::uint64_t activeRevision = 0) {
+        update(graph, active, activeRevision);
+        std::vector<Particle>& particles = graph.getParticles();
+        Stats stats;
+        for (int it = 0; it < std::max(1, iterations); ++it) {
+            float strain = 0;
+            for (std::size_t c = 0; c + 1 < batchStart.size(); ++c) {
+                std::size_t begin = batchStart[c], count = batchStart[c + 1] - begin;
+                // Maksimum z każdego bloku w osobnym polu - redukcja bez blokad i deterministyczna
+                blockStrain.assign((count + BLOCK_SIZE - 1) / BLOCK_SIZE, 0.0f);
+                pool.rownolegle(count, BLOCK_SIZE, [&](std::size_t from, std::size_t to) {
+                    float local = 0;
+                    for (std::size_t s = begin + from; s < begin + to; ++s) {
+                        local = std::max(local, sorted[s].applyConstraint(particles));
+                    }
+                    blockStrain[from / BLOCK_SIZE] = local;
+                });
+                for (float b : blockStrain) strain = std::max(strain, b);
+            }
+            stats.iterations = it + 1;
+            stats.maxStrain = strain;
+            if (strain <= tolerance) break;
+        }
+        return stats;
+    }
+
+    std::size_t colourCount() const { return batchStart.empty() ? 0 : batchStart.size() - 1; }
+
+private:
+    bool built = false;
+    std::uint64_t revision = 0, builtActiveRevision = 0;
+    std::vector<Spring> sorted;
+    std::vector<std::size_t> batchStart;
+    std::vector<float> blockStrain;
+};
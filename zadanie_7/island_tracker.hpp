@@ -0,0 +1,239 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+#include <algorithm>
+#include "cloth_graph.hpp"
+
+// Usypianie wysp - spójnych składowych grafu sprężyn. Wyspa, której każda cząsteczka przez
+// framesToSleep kolejnych kroków przesuwa się (position - previousPosition) o mniej niż
+// threshold, zasypia: prędkości jej cząsteczek są zerowane, a krok pomija dla niej grawitację,
+// całkowanie i więzy. Budzi ją wake() - przeciąganie albo edycja którejś z jej cząsteczek.
+// Przypięte cząsteczki też łączą wyspy, więc poruszenie przypiętego węzła budzi wszystko,
+// co jest do niego przymocowane. Stan snu pamiętany jest w slotach uchwytów, dlatego
+// przeżywa przebudowę wysp po zmianie grafu.
+class IslandTracker {
+public:
+    bool enabled = true;
+    float threshold = 0.05f; // [px na krok]
+    int framesToSleep = 60;
+
+    // Przebudowa wysp po zmianie grafu i list aktywnych cząsteczek i sprężyn; przed krokiem
+    void prepare(const ClothGraph& graph) {
+        if (!enabled) return;
+        update(graph);
+        if (listsValid) return;
+        listsValid = true;
+        particleList.clear();
+        springList.clear();
+        for (std::size_t k = 0; k < islands.size(); ++k) {
+            if (islands[k].sleeping) continue;
+            particleList.insert(particleList.end(), islandParticles.begin() + particleStart[k],
+                                islandParticles.begin() + particleStart[k + 1]);
+            springList.insert(springList.end(), islandSprings.begin() + springStart[k],
+                              islandSprings.begin() + springStart[k + 1]);
+        }
+    }
+
+    // Indeksy cząsteczek i sprężyn niespiących wysp albo nullptr, gdy żadna wyspa nie śpi
+    // (krok przechodzi wtedy po całym grafie, dokładnie jak bez usypiania)
+    const std::vector<std::uint32_t>* awakeParticles() const { return anySleeping() ? &particleList : nullptr; }
+    const std::vector<std::uint32_t>* awakeSprings() const { return anySleeping() ? &springList : nullptr; }
+
+    // Rośnie przy każdym zaśnięciu i obudzeniu wyspy - solver przebudowuje wtedy partie
+    std::uint64_t getRevision() const { return activeRevision; }
+
+    // Po kroku: liczy spokojne kroki niespiących wysp i usypia te, które odstały swoje
+    void settle(ClothGraph& graph) {
+        if (!enabled) return;
+        update(graph);
+        auto& particles = graph.getParticles();
+        const float limit = threshold * threshold;
+        for (std::size_t k = 0; k < islands.size(); ++k) {
+            Island& island = islands[k];
+            if (island.sleeping) continue;
+            bool quiet = true;
+            for (std::size_t p = particleStart[k]; p < particleStart[k + 1] && quiet; ++p) {
+                const Particle& particle = particles[islandParticles[p]];
+                sf::Vector2f v = particle.position - particle.previousPosition;
+                quiet = v.x * v.x + v.y * v.y < limit;
+            }
+            island.quietFrames = quiet ? island.quietFrames + 1 : 0;
+            if (island.quietFrames >= framesToSleep) sleep(graph, k);
+        }
+        ++steps;
+        awakeParticleSteps += particles.size() - sleepingParticles;
+    }
+
+    // Budzi wyspę cząsteczki o danym indeksie; przed edycją, póki indeks jest ważny
+    void wake(const ClothGraph& graph, int particle) {
+        if (!enabled || particle < 0) return;
+        update(graph);
+        if (static_cast<std::size_t>(particle) < particleIsland.size()) wakeIsland(graph, particleIsland[particle]);
+    }
+
+    // Budzi wszystko - po wczytaniu grafu, które unieważnia sloty
+    void wakeAll() {
+        sleepingSlot.clear();
+        built = false;
+    }
+
+    bool sleeping(std::size_t particle) const {
+        return enabled && particle < particleIsland.size() && islands[particleIsland[particle]].sleeping;
+    }
+
+    std::size_t islandCount() const { return islands.size(); }
+    std::size_t sleepingIslandCount() const { return sleepingIslands; }
+    std::size_t sleepingParticleCount() const { return sleepingParticles; }
+
+    void print() const {
+        if (!enabled) return;
+        std::printf("islands = %zu, sleeping = %zu (%zu particles), awake particles/step = %.1f\n", islands.size(),
+                    sleepingIslands, sleepingParticles,
+                    steps > 0 ? static_cast<double>(awakeParticleSteps) / steps : 0.0);
+    }
+
+private:
+    struct Island {
+        bool sleeping = false;
+        int quietFrames = 0;
+    };
+
+    bool built = false;
+    std::uint64_t revision = 0;
+    std::vector<Island> islands;
+    std::vector<std::uint32_t> particleIsland;
+    // Cząsteczki i sprężyny wyspy k leżą w [start[k], start[k + 1])
+    std::vector<std::uint32_t> islandParticles, islandSprings;
+    std::vector<std::size_t> particleStart, springStart;
+    std::vector<char> sleepingSlot;
+    std::vector<std::uint32_t> parent;
+
+    bool listsValid = false;
+    std::uint64_t activeRevision = 0;
+    std::vector<std::uint32_t> particleList, springList;
+
+    std::size_t sleepingIslands = 0, sleepingParticles = 0;
+    long long steps = 0, awakeParticleSteps = 0;
+
+    bool anySleeping() const { return enabled && sleepingIslands > 0; }
+
+    std::uint32_t find(std::uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Składowe spójne przez find-union po sprężynach; wyspa śpi dalej tylko wtedy,
+    // gdy spały wszystkie jej cząsteczki. Dodanie cząsteczki nie zmienia rewizji grafu,
+    // więc liczy się też rozmiar.
+    void update(const ClothGraph& graph) {
+        if (built && graph.getRevision() == revision && graph.getParticles().size() == particleIsland.size()) return;
+        built = true;
+        revision = graph.getRevision();
+        listsValid = false;
+        ++activeRevision;
+
+        const std::size_t n = graph.getParticles().size();
+        const auto& springs = graph.getSprings();
+        parent.resize(n);
+        std::iota(parent.begin(), parent.end(), 0u);
+        for (const auto& spring : springs) {
+            std::uint32_t a = find(spring.a), b = find(spring.b);
+            if (a != b) parent[std::max(a, b)] = std::min(a, b);
+        }
+
+        const std::uint32_t NONE = UINT32_MAX;
+        std::vector<std::uint32_t> islandOfRoot(n, NONE);
+        particleIsland.resize(n);
+        islands.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint32_t root = find(static_cast<std::uint32_t>(i));
+            if (islandOfRoot[root] == NONE) {
+                islandOfRoot[root] = static_cast<std::uint32_t>(islands.size());
+                islands.emplace_back();
+                islands.back().sleeping = true;
+            }
+            std::uint32_t k = islandOfRoot[root];
+            particleIsland[i] = k;
+            std::uint32_t slot = graph.handleOf(i).slot;
+            if (slot >= sleepingSlot.size() || !sleepingSlot[slot]) islands[k].sleeping = false;
+        }
+
+        // Sortowanie przez zliczanie po numerze wyspy
+        const std::size_t count = islands.size();
+        particleStart.assign(count + 1, 0);
+        springStart.assign(count + 1, 0);
+        for (std::size_t i = 0; i < n; ++i) ++particleStart[particleIsland[i] + 1];
+        for (const auto& spring : springs) ++springStart[particleIsland[spring.a] + 1];
+        for (std::size_t k = 0; k < count; ++k) {
+            particleStart[k + 1] += particleStart[k];
+            springStart[k + 1] += springStart[k];
+        }
+        islandParticles.resize(n);
+        islandSprings.resize(springs.size());
+        std::vector<std::size_t> next(particleStart.begin(), particleStart.end() - 1);
+        for (std::size_t i = 0; i < n; ++i) islandParticles[next[particleIsland[i]]++] = static_cast<std::uint32_t>(i);
+        next.assign(springStart.begin(), springStart.end() - 1);
+        for (std::size_t s = 0; s < springs.size(); ++s) {
+            islandSprings[next[particleIsland[springs[s].a]]++] = static_cast<std::uint32_t>(s);
+        }
+
+        // Sloty obudzonych wysp (np. połączonych z nową cząsteczką) przestają być uśpione
+        sleepingIslands = sleepingParticles = 0;
+        for (std::size_t k = 0; k < count; ++k) {
+            Island& island = islands[k];
+            std::size_t size = particleStart[k + 1] - particleStart[k];
+            if (island.sleeping) {
+                island.quietFrames = framesToSleep;
+                ++sleepingIslands;
+                sleepingParticles += size;
+            } else {
+                markSlots(graph, k, 0);
+            }
+        }
+    }
+
+    void markSlots(const ClothGraph& graph, std::size_t k, char value) {
+        for (std::size_t p = particleStart[k]; p < particleStart[k + 1]; ++p) {
+            std::uint32_t slot = graph.handleOf(islandParticles[p]).slot;
+            if (slot >= sleepingSlot.size()) {
+                if (!value) continue;
+                sleepingSlot.resize(slot + 1, 0);
+            }
+            sleepingSlot[slot] = value;
+        }
+    }
+
+    void sleep(ClothGraph& graph, std::size_t k) {
+        auto& particles = graph.getParticles();
+        for (std::size_t p = particleStart[k]; p < particleStart[k + 1]; ++p) {
+            Particle& particle = particles[islandParticles[p]];
+            particle.previousPosition = particle.position;
+            particle.acceleration = sf::Vector2f(0.f, 0.f);
+        }
+        markSlots(graph, k, 1);
+        islands[k].sleeping = true;
+        ++sleepingIslands;
+        sleepingParticles += particleStart[k + 1] - particleStart[k];
+        listsValid = false;
+        ++activeRevision;
+    }
+
+    void wakeIsland(const ClothGraph& graph, std::size_t k) {
+        Island& island = islands[k];
+        island.quietFrames = 0;
+        if (!island.sleeping) return;
+        island.sleeping = false;
+        --sleepingIslands;
+        sleepingParticles -= particleStart[k + 1] - particleStart[k];
+        markSlots(graph, k, 0);
+        listsValid = false;
+        ++activeRevision;
+    }
+};
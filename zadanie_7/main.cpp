@@ -3,250 +3,433 @@
 #include <cmath>
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <memory>
+#include "cloth_graph.hpp"
+#include "constraint_solver.hpp"
+#include "island_tracker.hpp"
+#include "cloth_generator.hpp"
+#include "particle_grid.hpp"
+#include "../wspolne/renderer_kol.hpp"
+#include "../wspolne/zasoby.hpp"
+#include "../wspolne/argumenty.hpp"
+#include "../wspolne/tryb_wsadowy.hpp"
+#include "../wspolne/losowanie.hpp"
+#include "../wspolne/profiler.hpp"
 
-// Struktura reprezentująca cząsteczkę
-struct Particle {
-    sf::Vector2f position;
-    sf::Vector2f previousPosition;
-    sf::Vector2f acceleration;
-    bool isPinned;
+sf::Color calculateSpringColor(float distance, float restLength) {
+    float ratio = distance / restLength;
+    ratio = std::min(1.f, ratio); // Clamp ratio to 1
+    return sf::Color(255 * ratio, 255 * (1 - ratio), 0); // Gradient od zielonego do czerwonego
+}
 
-    Particle(sf::Vector2f pos, bool pinned = false)
-        : position(pos), previousPosition(pos), acceleration(0.f, 0.f), isPinned(pinned) {}
+// Parametry symulacji
+const int windowWidth = 800;
+const int windowHeight = 600;
+const float gravityStrength = 500.f;
+const float deltaTime = 0.016f;
+
+// Jeden krok modelu: grawitacja, całkowanie Verleta i iteracje więzów sprężyn;
+// cząsteczki i sprężyny uśpionych wysp są pomijane
+ConstraintSolver::Stats simulationStep(ClothGraph& graph, ConstraintSolver& solver, IslandTracker& islands,
+                                       PulaWatkow& pool) {
+    islands.prepare(graph);
+    Strefa verletZone("verlet");
+    auto& particles = graph.getParticles();
+    auto integrate = [&](Particle& particle) {
+        particle.applyForce(sf::Vector2f(0.f, gravityStrength));
+        particle.update(deltaTime);
+    };
+    if (const auto* awake = islands.awakeParticles()) {
+        for (std::uint32_t i : *awake) integrate(particles[i]);
+    } else {
+        for (auto& particle : particles) integrate(particle);
+    }
+    verletZone.zakoncz();
 
-    void applyForce(const sf::Vector2f& force) {
-        if (!isPinned) {
-            acceleration += force;
-        }
+    Strefa constraintZone("constraints");
+    ConstraintSolver::Stats stats = solver.solve(graph, pool, islands.awakeSprings(), islands.getRevision());
+    constraintZone.zakoncz();
+
+    Strefa sleepZone("sleep");
+    islands.settle(graph);
+    return stats;
+}
+
+// Migawka grafu cząsteczek i sprężyn; błędy są wypisywane na stderr
+bool saveGraph(const std::string& path, bool compress, const ClothGraph& graph) {
+    ZapisMigawki snapshot("zadanie_7");
+    graph.save(snapshot);
+    if (snapshot.zapisz(path, compress)) return true;
+    std::fprintf(stderr, "%s: nie udało się zapisać migawki\n", path.c_str());
+    return false;
+}
+
+bool loadGraph(const std::string& path, ClothGraph& graph) {
+    OdczytMigawki snapshot;
+    if (!snapshot.otworz(path)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), snapshot.komunikat().c_str());
+        return false;
+    }
+    if (!graph.load(snapshot)) {
+        std::fprintf(stderr, "%s: migawka nie zawiera poprawnego grafu sprężyn\n", path.c_str());
+        return false;
     }
+    return true;
+}
 
-    void update(float deltaTime) {
-        if (!isPinned) {
-            sf::Vector2f temp = position;
-            position += position - previousPosition + acceleration * (deltaTime * deltaTime);
-            previousPosition = temp;
-            acceleration = sf::Vector2f(0.f, 0.f);
+// Promień kliknięcia wokół cząsteczki [px]
+const float pickRadius = 10.f;
+
+// Pełny przegląd - punkt odniesienia dla ParticleGrid w trybie wsadowym.
+// Najbliższa cząsteczka w promieniu (radius = nieskończoność - w ogóle), remis wygrywa niższy indeks.
+int linearNearest(const ClothGraph& graph, float x, float y, float radius, bool unpinnedOnly = false) {
+    const auto& particles = graph.getParticles();
+    int best = -1;
+    float bestDistance = radius * radius;
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        if (unpinnedOnly && particles[i].isPinned) continue;
+        float dx = particles[i].position.x - x, dy = particles[i].position.y - y;
+        float d = dx * dx + dy * dy;
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = static_cast<int>(i);
         }
     }
-};
+    return best;
+}
 
-// Struktura reprezentująca sprężynę
-struct Spring {
-    Particle* p1;
-    Particle* p2;
-    float restLength;
-    float stiffness;
-
-    Spring(Particle* particle1, Particle* particle2, float stiffness = 0.1f)
-        : p1(particle1), p2(particle2), stiffness(stiffness) {
-        restLength = std::sqrt(std::pow(p2->position.x - p1->position.x, 2) +
-                               std::pow(p2->position.y - p1->position.y, 2));
+// Zapytania myszy przez siatkę, z czasem ostatniego zapytania
+struct Picker {
+    ParticleGrid grid{2 * pickRadius};
+    double lastMicroseconds = 0;
+
+    // Najbliższa cząsteczka w promieniu kliknięcia albo uchwyt pusty
+    ParticleHandle pick(const ClothGraph& graph, float x, float y, bool unpinnedOnly = false) {
+        auto start = std::chrono::steady_clock::now();
+        int i = grid.findWithin(graph, x, y, pickRadius, unpinnedOnly);
+        lastMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return i >= 0 ? graph.handleOf(i) : ParticleHandle();
     }
 
-    void applyConstraint() {
-        sf::Vector2f delta = p2->position - p1->position;
-        float distance = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-        float difference = (distance - restLength) / distance;
-        sf::Vector2f offset = delta * stiffness * difference;
-
-        if (!p1->isPinned) p1->position += offset;
-        if (!p2->isPinned) p2->position -= offset;
+    ParticleHandle nearest(const ClothGraph& graph, float x, float y) {
+        auto start = std::chrono::steady_clock::now();
+        int i = grid.nearest(graph, x, y);
+        lastMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return i >= 0 ? graph.handleOf(i) : ParticleHandle();
     }
 };
 
-sf::Color calculateSpringColor(float distance, float restLength) {
-    float ratio = distance / restLength;
-    ratio = std::min(1.f, ratio); // Clamp ratio to 1
-    return sf::Color(255 * ratio, 255 * (1 - ratio), 0); // Gradient od zielonego do czerwonego
-}
+// Zapytania w losowych punktach obszaru cząsteczek: siatka kontra pełny przegląd
+void benchmarkPicking(ClothGraph& graph, long long queries) {
+    const auto& particles = graph.getParticles();
+    if (particles.empty() || queries <= 0) return;
+    float minX = particles[0].position.x, maxX = minX, minY = particles[0].position.y, maxY = minY;
+    for (const auto& p : particles) {
+        minX = std::min(minX, p.position.x); maxX = std::max(maxX, p.position.x);
+        minY = std::min(minY, p.position.y); maxY = std::max(maxY, p.position.y);
+    }
+    GeneratorLosowy generator(1);
+    std::vector<sf::Vector2f> points;
+    for (long long q = 0; q < queries; ++q) {
+        float x = generator.przedzial(minX, maxX);
+        float y = generator.przedzial(minY, maxY);
+        points.emplace_back(x, y);
+    }
 
-int main() {
-    // Parametry symulacji
-    const int windowWidth = 800;
-    const int windowHeight = 600;
-    const float gravityStrength = 500.f;
-    const float deltaTime = 0.016f;
+    ParticleGrid grid(2 * pickRadius);
+    auto start = std::chrono::steady_clock::now();
+    grid.rebuild(graph);
+    double rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> gridPick, gridNearest, linearPick, linearNearestResult;
+    start = std::chrono::steady_clock::now();
+    for (const auto& p : points) gridPick.push_back(grid.findWithin(graph, p.x, p.y, pickRadius));
+    for (const auto& p : points) gridNearest.push_back(grid.nearest(graph, p.x, p.y));
+    double gridUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (const auto& p : points) linearPick.push_back(linearNearest(graph, p.x, p.y, pickRadius));
+    for (const auto& p : points) {
+        linearNearestResult.push_back(linearNearest(graph, p.x, p.y, std::numeric_limits<float>::infinity()));
+    }
+    double linearUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
 
-    // Inicjalizacja okna SFML
-    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Zaawansowany model fizyczny");
-    window.setFramerateLimit(60);
+    bool same = gridPick == linearPick && gridNearest == linearNearestResult;
+    std::printf("picking: rebuild = %.3f ms, grid = %.2f us/query, linear = %.2f us/query, results %s\n",
+                rebuildMs, gridUs / (2 * queries), linearUs / (2 * queries), same ? "identical" : "DIFFER");
+}
 
-    // Tworzenie cząsteczek
-    std::vector<Particle> particles;
-    const int numParticles = 10;
-    const float particleSpacing = 50.f;
+// Uruchomienie: model_fizyczny [--cloth KOLUMNYxWIERSZE [--spacing S] [--pin-rows N] | --load PLIK]
+//               [--save PLIK [--compress]] [--iterations N] [--tolerance T] [--threads N]
+//               [--no-sleep | --sleep-threshold PX [--sleep-frames N]]
+//               [--headless KROKI [--pick ZAPYTANIA]] [--profile] [--trace PLIK]
+// Model jest w pełni deterministyczny, więc --seed nie jest potrzebny
+int main(int argc, char* argv[]) {
+    Argumenty args(argc, argv);
+    wlaczProfiler(args);
+
+    PulaWatkow pool(static_cast<unsigned>(args.liczbaCalkowita("threads", std::thread::hardware_concurrency())));
+    ConstraintSolver solver;
+    solver.iterations = static_cast<int>(args.liczbaCalkowita("iterations", solver.iterations));
+    solver.tolerance = args.liczba("tolerance", solver.tolerance);
+    IslandTracker islands;
+    islands.enabled = !args.jest("no-sleep");
+    islands.threshold = args.liczba("sleep-threshold", islands.threshold);
+    islands.framesToSleep = static_cast<int>(args.liczbaCalkowita("sleep-frames", islands.framesToSleep));
+
+    // --load: graf z migawki zamiast tkaniny lub łańcucha; --save: zapis po przebiegu
+    // wsadowym albo klawiszem F5 w oknie (F9 wczytuje ponownie)
+    const std::string savePath = args.tekst("save", "zadanie_7.migawka");
+    const std::string loadPath = args.tekst("load", savePath);
+    const bool compress = args.jest("compress");
+
+    ClothGraph graph;
+    if (args.jest("load")) {
+        if (!loadGraph(loadPath, graph)) return 1;
+    } else if (args.jest("cloth")) {
+        // Tkanina wyśrodkowana w poziomie; domyślny odstęp mieści ją w oknie
+        ClothParams cloth;
+        if (!parseClothSize(args.tekst("cloth", ""), cloth)) {
+            std::fprintf(stderr, "--cloth: oczekiwano rozmiaru KOLUMNYxWIERSZE, np. 100x80\n");
+            return 1;
+        }
+        cloth.spacing = args.liczba("spacing", std::min(20.f, 700.f / std::max(1, cloth.columns - 1)));
+        cloth.pinnedRows = static_cast<int>(args.liczbaCalkowita("pin-rows", cloth.pinnedRows));
+        cloth.origin = sf::Vector2f((windowWidth - (cloth.columns - 1) * cloth.spacing) / 2.f, 50.f);
+        buildCloth(graph, cloth);
+    } else {
+        // Tworzenie cząsteczek
+        const int numParticles = 10;
+        const float particleSpacing = 50.f;
+
+        std::vector<ParticleHandle> chain;
+        for (int i = 0; i < numParticles; ++i) {
+            chain.push_back(graph.addParticle(sf::Vector2f(300.f + i * particleSpacing, 300.f), i == 0)); // Pierwsza cząsteczka przypięta
+        }
 
-    for (int i = 0; i < numParticles; ++i) {
-        particles.emplace_back(sf::Vector2f(300.f + i * particleSpacing, 300.f), i == 0); // Pierwsza cząsteczka przypięta
+        // Tworzenie sprężyn
+        for (int i = 0; i < numParticles - 1; ++i) {
+            graph.addSpring(chain[i], chain[i + 1]);
+        }
     }
 
-    // Tworzenie sprężyn
-    std::vector<Spring> springs;
-    for (int i = 0; i < numParticles - 1; ++i) {
-        springs.emplace_back(&particles[i], &particles[i + 1]);
+    // Tryb wsadowy: stała liczba kroków bez otwierania okna
+    if (args.jest("headless")) {
+        long long steps = args.liczbaCalkowita("headless", 1000);
+        PomiarWsadowy measurement;
+        ConstraintSolver::Stats stats;
+        long long totalIterations = 0;
+        measurement.start();
+        for (long long i = 0; i < steps; ++i) {
+            profiler().poczatekKlatki();
+            stats = simulationStep(graph, solver, islands, pool);
+            profiler().koniecKlatki();
+            totalIterations += stats.iterations;
+            measurement.krok(graph.getParticles().size());
+        }
+        measurement.stop();
+
+        SumaKontrolna checksum;
+        for (const auto& particle : graph.getParticles()) {
+            checksum.dodaj(particle.position.x);
+            checksum.dodaj(particle.position.y);
+            checksum.dodaj(particle.previousPosition.x);
+            checksum.dodaj(particle.previousPosition.y);
+        }
+        std::printf("particles = %zu, springs = %zu, colours = %zu, threads = %u\n", graph.getParticles().size(),
+                    graph.getSprings().size(), solver.colourCount(), pool.liczbaWatkow());
+        std::printf("ms/step = %.4f, iterations/step = %.2f, max strain = %g\n",
+                    steps > 0 ? measurement.sekundy() * 1e3 / steps : 0.0,
+                    steps > 0 ? static_cast<double>(totalIterations) / steps : 0.0, stats.maxStrain);
+        islands.print();
+        measurement.wypisz("zadanie_7", checksum.wartosc());
+        if (!zakonczProfiler(args)) return 1;
+        if (args.jest("save") && !saveGraph(savePath, compress, graph)) return 1;
+        if (args.jest("pick")) benchmarkPicking(graph, args.liczbaCalkowita("pick", 10000));
+        return 0;
     }
 
-    // Interakcja użytkownika
+    // Napis trybu edycji tworzony raz; bez czcionki tryb edycji działa, tylko bez napisu
+    Zasoby resources(argv[0]);
+    std::unique_ptr<sf::Text> editingText;
+    if (const sf::Font* font = resources.czcionka("arial.ttf")) {
+        editingText.reset(new sf::Text("Editing Mode", *font, 20));
+        editingText->setFillColor(sf::Color::White);
+        editingText->setPosition(10.f, 10.f);
+    } else {
+        std::fprintf(stderr, "Brak czcionki arial.ttf - napis trybu edycji nie będzie wyświetlany\n");
+    }
+
+    // Inicjalizacja okna SFML
+    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Zaawansowany model fizyczny");
+    window.setFramerateLimit(60);
+
+    // Interakcja użytkownika; uchwyty pozostają ważne przy dodawaniu i usuwaniu cząsteczek
     bool dragging = false;
-    Particle* draggedParticle = nullptr;
+    ParticleHandle draggedParticle;
 
     // Stan tworzenia sprężyny
     bool creatingSpring = false;
-    Particle* firstParticle = nullptr;
+    ParticleHandle firstParticle;
 
     // Tryb edycji
     bool isEditing = false;
 
+    // Indeks do zapytań myszy, przebudowywany po każdym kroku
+    Picker picker;
+
+    // Sprężyny jedną tablicą linii, cząsteczki jedną partią kół
+    sf::VertexArray springLines(sf::Lines);
+    RendererKol particleBatch;
+    NakladkaProfilera overlay(resources.czcionka("arial.ttf"));
+    overlay.widoczna = profiler().wlaczony();
+    std::size_t otherDraws = 0; // linie sprężyn i napis trybu edycji
+
     while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
+        profiler().poczatekKlatki();
+        {
+            Strefa zone("events");
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    window.close();
+                }
 
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::Space) {
-                    isEditing = !isEditing; // Przełącz tryb edycji
+                if (event.type == sf::Event::KeyPressed) {
+                    if (event.key.code == sf::Keyboard::Space) {
+                        isEditing = !isEditing; // Przełącz tryb edycji
+                    } else if (event.key.code == sf::Keyboard::F5) {
+                        saveGraph(savePath, compress, graph);
+                    } else if (event.key.code == sf::Keyboard::F9 && loadGraph(loadPath, graph)) {
+                        // Uchwyty sprzed wczytania są już nieważne
+                        dragging = creatingSpring = false;
+                        islands.wakeAll();
+                    } else if (event.key.code == sf::Keyboard::F3) {
+                        profiler().wlacz(true);
+                        overlay.widoczna = !overlay.widoczna;
+                    }
                 }
-            }
 
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    if (!isEditing) {
-                        for (auto& particle : particles) {
-                            if (std::hypot(particle.position.x - event.mouseButton.x, particle.position.y - event.mouseButton.y) < 10.f) {
-                                dragging = true;
-                                draggedParticle = &particle;
-                                break;
-                            }
+                if (event.type == sf::Event::MouseButtonPressed) {
+                    float mouseX = static_cast<float>(event.mouseButton.x);
+                    float mouseY = static_cast<float>(event.mouseButton.y);
+                    if (event.mouseButton.button == sf::Mouse::Left) {
+                        // Tryb edycji - przesuwanie tylko nieprzypiętych cząsteczek
+                        ParticleHandle picked = picker.pick(graph, mouseX, mouseY, isEditing);
+                        if (graph.valid(picked)) {
+                            dragging = true;
+                            draggedParticle = picked;
                         }
-                    } else {
-                        // Tryb edycji - przesuwanie nieprzypiętych cząsteczek
-                        for (auto& particle : particles) {
-                            if (!particle.isPinned &&
-                                std::hypot(particle.position.x - event.mouseButton.x, particle.position.y - event.mouseButton.y) < 10.f) {
-                                dragging = true;
-                                draggedParticle = &particle;
-                                break;
-                            }
-                        }
-                    }
-                } else if (event.mouseButton.button == sf::Mouse::Right) {
-                    if (isEditing) {
-                        bool foundParticle = false;
-                        for (auto& particle : particles) {
-                            if (std::hypot(particle.position.x - event.mouseButton.x, particle.position.y - event.mouseButton.y) < 10.f) {
+                    } else if (event.mouseButton.button == sf::Mouse::Right) {
+                        if (isEditing) {
+                            ParticleHandle picked = picker.pick(graph, mouseX, mouseY);
+                            if (graph.valid(picked)) {
                                 if (!creatingSpring) {
                                     creatingSpring = true;
-                                    firstParticle = &particle;
+                                    firstParticle = picked;
                                 } else {
-                                    springs.emplace_back(firstParticle, &particle);
+                                    islands.wake(graph, graph.indexOf(firstParticle));
+                                    islands.wake(graph, graph.indexOf(picked));
+                                    graph.addSpring(firstParticle, picked);
                                     creatingSpring = false;
-                                    firstParticle = nullptr;
+                                    firstParticle = ParticleHandle();
                                 }
-                                foundParticle = true;
-                                break;
-                            }
-                        }
-
-                        if (!foundParticle) {
-                            sf::Vector2f newPosition(event.mouseButton.x, event.mouseButton.y);
-                            particles.emplace_back(newPosition);
-
-                            // Znajdź najbliższą istniejącą cząsteczkę i połącz nową sprężyną
-                            Particle* closestParticle = nullptr;
-                            float closestDistance = std::numeric_limits<float>::max();
-                            for (auto& particle : particles) {
-                                if (&particle != &particles.back()) {
-                                    float distance = std::hypot(particle.position.x - newPosition.x, particle.position.y - newPosition.y);
-                                    if (distance < closestDistance) {
-                                        closestDistance = distance;
-                                        closestParticle = &particle;
-                                    }
+                            } else {
+                                sf::Vector2f newPosition(mouseX, mouseY);
+
+                                // Znajdź najbliższą istniejącą cząsteczkę i połącz nową sprężyną
+                                ParticleHandle closest = picker.nearest(graph, mouseX, mouseY);
+                                islands.wake(graph, graph.indexOf(closest));
+                                ParticleHandle added = graph.addParticle(newPosition);
+                                if (graph.valid(closest)) {
+                                    graph.addSpring(closest, added);
                                 }
                             }
-
-                            if (closestParticle) {
-                                springs.emplace_back(closestParticle, &particles.back());
-                            }
                         }
-                    }
-                } else if (event.mouseButton.button == sf::Mouse::Middle) {
-                    if (isEditing) {
-                        for (auto it = particles.begin(); it != particles.end(); ++it) {
-                            if (std::hypot(it->position.x - event.mouseButton.x, it->position.y - event.mouseButton.y) < 10.f) {
-                                // Usuwanie sprężyn powiązanych z tą cząsteczką
-                                springs.erase(std::remove_if(springs.begin(), springs.end(), [&](const Spring& spring) {
-                                    return spring.p1 == &(*it) || spring.p2 == &(*it);
-                                }), springs.end());
-                                particles.erase(it);
-                                break;
-                            }
+                    } else if (event.mouseButton.button == sf::Mouse::Middle) {
+                        if (isEditing) {
+                            // Usuwanie cząsteczki razem z powiązanymi sprężynami; sąsiedzi się budzą
+                            ParticleHandle picked = picker.pick(graph, mouseX, mouseY);
+                            islands.wake(graph, graph.indexOf(picked));
+                            graph.removeParticle(picked);
                         }
                     }
+                    window.setTitle("Zaawansowany model fizyczny [zapytanie: " +
+                                    std::to_string(picker.lastMicroseconds).substr(0, 5) + " us]");
                 }
-            }
 
-            if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
-                dragging = false;
-                draggedParticle = nullptr;
+                if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+                    dragging = false;
+                    draggedParticle = ParticleHandle();
+                }
             }
         }
 
+        // Przeciągana cząsteczka nie pozwala zasnąć swojej wyspie
+        if (dragging) islands.wake(graph, graph.indexOf(draggedParticle));
         if (!isEditing) {
-            // Aktualizacja stanu cząsteczek
-            for (auto& particle : particles) {
-                particle.applyForce(sf::Vector2f(0.f, gravityStrength));
-                particle.update(deltaTime);
-            }
-
-            // Aktualizacja sprężyn
-            for (auto& spring : springs) {
-                spring.applyConstraint();
-            }
+            simulationStep(graph, solver, islands, pool);
         }
 
         // Aktualizacja pozycji przeciąganej cząsteczki w trybie edycji
-        if (dragging && draggedParticle) {
+        if (Particle* dragged = dragging ? graph.get(draggedParticle) : nullptr) {
             sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-            draggedParticle->position = sf::Vector2f(mousePos.x, mousePos.y);
+            dragged->position = sf::Vector2f(mousePos.x, mousePos.y);
+        }
+
+        // Indeks zapytań myszy odpowiada pozycjom z tej klatki
+        {
+            Strefa zone("grid");
+            picker.grid.rebuild(graph);
         }
 
         // Rysowanie
+        Strefa drawZone("draw");
         window.clear();
 
-        for (const auto& spring : springs) {
-            float distance = std::sqrt(std::pow(spring.p2->position.x - spring.p1->position.x, 2) +
-                                       std::pow(spring.p2->position.y - spring.p1->position.y, 2));
-            sf::Color color = calculateSpringColor(distance, spring.restLength);
-            sf::Vertex line[] = {
-                sf::Vertex(spring.p1->position, color),
-                sf::Vertex(spring.p2->position, color)
-            };
-            window.draw(line, 2, sf::Lines);
+        const auto& particles = graph.getParticles();
+        const auto& springs = graph.getSprings();
+        springLines.resize(2 * springs.size());
+        for (std::size_t i = 0; i < springs.size(); ++i) {
+            const Particle& p1 = particles[springs[i].a];
+            const Particle& p2 = particles[springs[i].b];
+            float distance = std::sqrt(std::pow(p2.position.x - p1.position.x, 2) +
+                                       std::pow(p2.position.y - p1.position.y, 2));
+            sf::Color color = calculateSpringColor(distance, springs[i].restLength);
+            springLines[2 * i] = sf::Vertex(p1.position, color);
+            springLines[2 * i + 1] = sf::Vertex(p2.position, color);
         }
-
-        for (const auto& particle : particles) {
-            sf::CircleShape shape(5.f);
-            shape.setOrigin(5.f, 5.f);
-            shape.setPosition(particle.position);
-            shape.setFillColor(particle.isPinned ? sf::Color::Red : sf::Color::Blue);
-            window.draw(shape);
+        window.draw(springLines);
+        ++otherDraws;
+
+        // Koło o promieniu 5 wyśrodkowane na cząsteczce; uśpione przygaszone
+        particleBatch.zacznij(particles.size());
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            sf::Color color = particles[i].isPinned ? sf::Color::Red : sf::Color::Blue;
+            if (islands.sleeping(i)) color = sf::Color(color.r / 2, color.g / 2, color.b / 2);
+            particleBatch.ustaw(i, particles[i].position.x - 5.f, particles[i].position.y - 5.f, 5.f, color);
         }
+        particleBatch.rysuj(window);
 
         // Informacja o trybie edycji
-        if (isEditing) {
-            sf::Font font;
-            if (font.loadFromFile("arial.ttf")) {
-                sf::Text text("Editing Mode", font, 20);
-                text.setFillColor(sf::Color::White);
-                text.setPosition(10.f, 10.f);
-                window.draw(text);
-            }
+        if (isEditing && editingText) {
+            window.draw(*editingText);
+            ++otherDraws;
         }
 
-        window.display();
+        overlay.rysuj(window, particles.size(), particleBatch.wywolania() + otherDraws);
+        drawZone.zakoncz();
+        {
+            Strefa zone("display");
+            window.display();
+        }
+        profiler().koniecKlatki();
     }
 
-    return 0;
+    return zakonczProfiler(args) ? 0 : 1;
 }
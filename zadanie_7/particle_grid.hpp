@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include "cloth_graph.hpp"
+
+// Jednorodna siatka nad cząsteczkami grafu do zapytań myszy: cząsteczka w promieniu
+// kliknięcia i najbliższa cząsteczka. Budowana sortowaniem przez zliczanie po każdym
+// kroku; między przebudowami zapytania przebudowują ją same, jeśli graf się zmienił.
+class ParticleGrid {
+public:
+    // Maksymalna liczba komórek w jednym wymiarze - przy rozrzuconych cząsteczkach komórki są powiększane
+    static const int MAX_CELLS = 1024;
+
+    explicit ParticleGrid(float cellSize = 20.f) : minCellSize(cellSize) {}
+
+    void rebuild(const ClothGraph& graph) {
+        builtRevision = graph.getRevision();
+        const auto& particles = graph.getParticles();
+        builtSize = particles.size();
+        int n = static_cast<int>(particles.size());
+        sorted.resize(n);
+        cellOfParticle.resize(n);
+        if (n == 0) {
+            cellStart.assign(1, 0);
+            columns = rows = 0;
+            return;
+        }
+
+        minX = maxX = particles[0].position.x;
+        minY = maxY = particles[0].position.y;
+        for (const auto& p : particles) {
+            minX = std::min(minX, p.position.x); maxX = std::max(maxX, p.position.x);
+            minY = std::min(minY, p.position.y); maxY = std::max(maxY, p.position.y);
+        }
+        cellSize = std::max({minCellSize, (maxX - minX) / MAX_CELLS, (maxY - minY) / MAX_CELLS});
+        columns = static_cast<int>((maxX - minX) / cellSize) + 1;
+        rows = static_cast<int>((maxY - minY) / cellSize) + 1;
+
+        cellStart.assign(static_cast<std::size_t>(columns) * rows + 1, 0);
+        for (int i = 0; i < n; ++i) {
+            cellOfParticle[i] = row(particles[i].position.y) * columns + column(particles[i].position.x);
+            ++cellStart[cellOfParticle[i] + 1];
+        }
+        for (std::size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+        fill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < n; ++i) sorted[fill[cellOfParticle[i]]++] = i;
+    }
+
+    // Przebudowa tylko wtedy, gdy od ostatniej zmieniły się indeksy lub liczba cząsteczek
+    void refresh(const ClothGraph& graph) {
+        if (graph.getRevision() != builtRevision || graph.getParticles().size() != builtSize) rebuild(graph);
+    }
+
+    // Najbliższa cząsteczka w promieniu radius (opcjonalnie tylko nieprzypięta) albo -1
+    int findWithin(const ClothGraph& graph, float x, float y, float radius, bool unpinnedOnly = false) {
+        refresh(graph);
+        const auto& particles = graph.getParticles();
+        if (columns == 0) return -1;
+        int x0 = column(x - radius), x1 = column(x + radius);
+        int y0 = row(y - radius), y1 = row(y + radius);
+        int best = -1;
+        float bestDistance = radius * radius;
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                int c = cy * columns + cx;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                    int i = sorted[k];
+                    if (unpinnedOnly && particles[i].isPinned) continue;
+                    float dx = particles[i].position.x - x, dy = particles[i].position.y - y;
+                    float d = dx * dx + dy * dy;
+                    if (d < bestDistance || (d == bestDistance && best >= 0 && i < best)) {
+                        bestDistance = d;
+                        best = i;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    // Najbliższa cząsteczka w ogóle albo -1 dla pustego grafu. Przegląd pierścieniami komórek
+    // wokół punktu kończy się, gdy kolejny pierścień nie może już zawierać nic bliższego.
+    int nearest(const ClothGraph& graph, float x, float y) {
+        refresh(graph);
+        const auto& particles = graph.getParticles();
+        if (columns == 0) return -1;
+        int qx = column(x), qy = row(y);
+        int best = -1;
+        float bestDistance = std::numeric_limits<float>::max();
+        int maxRing = std::max(columns, rows);
+        for (int r = 0; r <= maxRing; ++r) {
+            for (int cy = qy - r; cy <= qy + r; ++cy) {
+                if (cy < 0 || cy >= rows) continue;
+                // Na brzegowych wierszach pierścienia cały wiersz, na pozostałych tylko dwie skrajne komórki
+                int step = (cy == qy - r || cy == qy + r) ? 1 : std::max(1, 2 * r);
+                for (int cx = qx - r; cx <= qx + r; cx += step) {
+                    if (cx < 0 || cx >= columns) continue;
+                    int c = cy * columns + cx;
+                    for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                        int i = sorted[k];
+                        float dx = particles[i].position.x - x, dy = particles[i].position.y - y;
+                        float d = dx * dx + dy * dy;
+                        if (d < bestDistance || (d == bestDistance && i < best)) {
+                            bestDistance = d;
+                            best = i;
+                        }
+                    }
+                }
+            }
+            // Komórki dalszych pierścieni leżą co najmniej r * cellSize od punktu
+            float reach = r * cellSize;
+            if (best >= 0 && bestDistance <= reach * reach) break;
+        }
+        return best;
+    }
+
+private:
+    float minCellSize;
+    float cellSize = 1;
+    float minX = 0, maxX = 0, minY = 0, maxY = 0;
+    int columns = 0, rows = 0;
+    std::vector<int> cellOfParticle;
+    std::vector<int> cellStart;
+    std::vector<int> fill;
+    std::vector<int> sorted;
+    std::uint64_t builtRevision = UINT64_MAX;
+    std::size_t builtSize = 0;
+
+    // Punkty spoza siatki trafiają do komórek brzegowych; max przed min chroni przed NaN
+    int column(float x) const {
+        float c = std::max(0.0f, (x - minX) / cellSize);
+        return static_cast<int>(std::min(c, static_cast<float>(columns - 1)));
+    }
+    int row(float y) const {
+        float c = std::max(0.0f, (y - minY) / cellSize);
+        return static_cast<int>(std::min(c, static_cast<float>(rows - 1)));
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+// Struktura reprezentująca cząsteczkę
+struct Particle {
+    sf::Vector2f position;
+    sf::Vector2f previousPosition;
+    sf::Vector2f acceleration;
+    bool isPinned;
+
+    Particle(sf::Vector2f pos, bool pinned = false)
+        : position(pos), previousPosition(pos), acceleration(0.f, 0.f), isPinned(pinned) {}
+
+    void applyForce(const sf::Vector2f& force) {
+        if (!isPinned) {
+            acceleration += force;
+        }
+    }
+
+    void update(float deltaTime) {
+        if (!isPinned) {
+            sf::Vector2f temp = position;
+            position += position - previousPosition + acceleration * (deltaTime * deltaTime);
+            previousPosition = temp;
+            acceleration = sf::Vector2f(0.f, 0.f);
+        }
+    }
+};
+
+// Struktura reprezentująca sprężynę - indeksy dwóch cząsteczek we wspólnym wektorze
+struct Spring {
+    std::uint32_t a;
+    std::uint32_t b;
+    float restLength;
+    float stiffness;
+
+    Spring(const std::vector<Particle>& particles, std::uint32_t a, std::uint32_t b, float stiffness = 0.1f)
+        : a(a), b(b), stiffness(stiffness) {
+        const Particle& p1 = particles[a];
+        const Particle& p2 = particles[b];
+        restLength = std::sqrt(std::pow(p2.position.x - p1.position.x, 2) +
+                               std::pow(p2.position.y - p1.position.y, 2));
+    }
+
+    // Zwraca względne odkształcenie przed korektą, |d - L| / d
+    float applyConstraint(std::vector<Particle>& particles) const {
+        Particle& p1 = particles[a];
+        Particle& p2 = particles[b];
+        sf::Vector2f delta = p2.position - p1.position;
+        float distance = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+        float difference = (distance - restLength) / distance;
+        sf::Vector2f offset = delta * stiffness * difference;
+
+        if (!p1.isPinned) p1.position += offset;
+        if (!p2.isPinned) p2.position -= offset;
+        return std::abs(difference);
+    }
+};